@@ -0,0 +1,86 @@
+/*
+
+	mazeArena.h
+
+	One heap block handed out front to back, for buffers that are always
+	rebuilt together, such as the two wall bitplanes of a loaded maze.
+
+	reset() takes every allocation back but keeps the block, so a load that
+	fits in the block makes no allocator calls. The block only grows, to the
+	largest size asked for, until release(). It is owned by the arena and
+	freed with it.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+class MazeArena {
+
+public:
+
+	MazeArena() : words(0), top(0) {}
+
+	// Take back every allocation, keeping the block
+	void reset() { top = 0; }
+
+	// Take back every allocation and make the block at least bytes long.
+	// The old block is freed before the new one is allocated, so the two
+	// are never held at once.
+	void reserve(size_t bytes)
+	{
+		top = 0;
+		size_t need = (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+		if (need <= words)
+			return;
+		block.reset();
+		words = 0;
+		block.reset(new uint64_t[need]);
+		words = need;
+	}
+
+	// Free the block
+	void release()
+	{
+		block.reset();
+		words = top = 0;
+	}
+
+	void swap(MazeArena& other)
+	{
+		block.swap(other.block);
+		std::swap(words, other.words);
+		std::swap(top, other.top);
+	}
+
+	// bytes from the block, 8-byte aligned, or nullptr if they do not fit
+	void* allocate(size_t bytes)
+	{
+		size_t n = (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+		if (n > words - top)
+			return nullptr;
+		uint64_t* p = block.get() + top;
+		top += n;
+		return p;
+	}
+
+	template <class T>
+	T* allocate(size_t count) { return (T*)allocate(count * sizeof(T)); }
+
+	// Bytes in the block, and bytes handed out since the last reset
+	size_t capacity() const { return words * sizeof(uint64_t); }
+	size_t used() const { return top * sizeof(uint64_t); }
+
+private:
+
+	MazeArena(const MazeArena&);
+	MazeArena& operator=(const MazeArena&);
+
+	std::unique_ptr<uint64_t[]> block;
+	size_t words; // size of the block
+	size_t top; // words handed out
+
+};
@@ -0,0 +1,209 @@
+/*
+
+	mazeAstar.h
+
+	A* from the entrance to the exit with the Manhattan distance heuristic.
+
+	With unit steps and a Manhattan heuristic a step changes f by 0 (toward
+	the exit) or 2 (away from it), so every open cell has f equal to the
+	current minimum F or to F + 2. The open list is therefore two buckets,
+	popped last in first out so ties go to the deepest cell.
+
+	Because open cells only hold one of two f values, a cell needs no g
+	score: two bits tell unseen, closed, or which of the two buckets it is
+	in (by bit 1 of f). With the two-bit parent links a search takes half a
+	byte per cell.
+
+	The search can also run in pieces: start() sets it up and step()
+	expands a bounded number of cells, keeping all its state in the object
+	between calls. solve() is start() and one step() that runs to the end.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "mazeBitset.h"
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeAstar {
+
+public:
+
+	MazeAstar() : expanded(0), opened(nullptr), closed(nullptr), status(IDLE), H(0), W(0), goal(0), F(0) {}
+
+	// Find a shortest path from the entrance to the exit. Returns false if
+	// there is none, in which case path is left empty.
+	template <class Grid>
+	bool solve(const Grid& grid, MazePath& path);
+
+	// Set up a search from the entrance to the exit
+	template <class Grid>
+	void start(const Grid& grid);
+
+	// Close up to maxSteps more cells. Returns true while the search has
+	// more to do. grid must not change while it runs.
+	template <class Grid>
+	bool step(const Grid& grid, size_t maxSteps);
+
+	// Abandon the search
+	void stop() { status = IDLE; }
+
+	bool running() const { return status == RUNNING; }
+	bool done() const { return status == FOUND || status == FAILED; }
+	bool found() const { return status == FOUND; }
+
+	// Fill out with the path found, or leave it empty if there is none
+	template <class Grid>
+	void path(const Grid& grid, MazePath& out) const;
+
+	// Cells closed by the last solve, or so far
+	size_t expanded;
+
+	// When set, step() appends each cell it first opens to opened and each
+	// cell it closes to closed
+	std::vector<uint64_t>* opened;
+	std::vector<uint64_t>* closed;
+
+	// Watched by solve, which stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const {
+		return state.memoryBytes() + parent.memoryBytes()
+			+ (bucket.capacity() + nextBucket.capacity()) * sizeof(uint64_t);
+	}
+
+private:
+
+	enum Status { IDLE, RUNNING, FOUND, FAILED };
+	enum { UNSEEN = 0, CLOSED = 3 };
+	// State of an open cell with the given f
+	static int openState(size_t f) { return (int)((f >> 1) & 1) + 1; }
+
+	Status status;
+	int H, W;
+	size_t goal;
+	MazeDirArray state;
+	MazeDirArray parent;
+	std::vector<uint64_t> bucket; // open cells with f == F
+	std::vector<uint64_t> nextBucket; // open cells with f == F + 2
+	size_t F;
+
+};
+
+template <class Grid>
+bool MazeAstar::solve(const Grid& grid, MazePath& path)
+{
+	start(grid);
+	step(grid, SIZE_MAX);
+	bool ok = found();
+	this->path(grid, path);
+	stop();
+	return ok;
+}
+
+template <class Grid>
+void MazeAstar::start(const Grid& grid)
+{
+	expanded = 0;
+	if (grid.empty()) {
+		status = FAILED;
+		return;
+	}
+
+	H = grid.height();
+	W = grid.width();
+	size_t cells = grid.cellCount();
+	state.reset(cells);
+	parent.reset(cells);
+	for (size_t i = 0; i < cells; i++)
+		state.set(i, UNSEEN);
+	bucket.clear();
+	nextBucket.clear();
+
+	size_t source = grid.index(grid.entranceRow, grid.entranceCol);
+	goal = grid.index(grid.exitRow, grid.exitCol);
+	F = abs(grid.entranceRow - grid.exitRow) + abs(grid.entranceCol - grid.exitCol);
+	state.set(source, openState(F));
+	bucket.push_back(source);
+	status = RUNNING;
+	if (opened)
+		opened->push_back(source);
+}
+
+template <class Grid>
+bool MazeAstar::step(const Grid& grid, size_t maxSteps)
+{
+	if (status != RUNNING)
+		return false;
+	int er = grid.exitRow, ec = grid.exitCol;
+	for (size_t n = 0; n < maxSteps;) {
+		if (cancel.poll()) {
+			status = IDLE;
+			return false;
+		}
+		if (bucket.empty()) {
+			if (nextBucket.empty()) {
+				status = FAILED;
+				return false;
+			}
+			bucket.swap(nextBucket);
+			F += 2;
+		}
+		size_t cur = bucket.back();
+		bucket.pop_back();
+		// Stale entry of a cell that was improved or closed since
+		if (state.get(cur) != openState(F))
+			continue;
+		state.set(cur, CLOSED);
+		expanded++;
+		n++;
+		if (closed)
+			closed->push_back(cur);
+		if (cur == goal) {
+			status = FOUND;
+			return false;
+		}
+
+		int row = (int)(cur / W);
+		int col = (int)(cur % W);
+		int h = abs(row - er) + abs(col - ec);
+		for (int dir = 0; dir < 4; dir++) {
+			if (!grid.canMove(row, col, dir))
+				continue;
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr < 0 || nr >= H || nc < 0 || nc >= W)
+				continue;
+			size_t next = grid.index(nr, nc);
+			int s = state.get(next);
+			if (s == CLOSED)
+				continue;
+
+			bool closer = abs(nr - er) + abs(nc - ec) < h;
+			size_t f = closer ? F : F + 2;
+			// Keep an open cell unless this reaches it with a lower f
+			if (s != UNSEEN && (s == openState(F) || !closer))
+				continue;
+			if (s == UNSEEN && opened)
+				opened->push_back(next);
+			state.set(next, openState(f));
+			parent.set(next, dir);
+			(closer ? bucket : nextBucket).push_back(next);
+		}
+	}
+	return true;
+}
+
+template <class Grid>
+void MazeAstar::path(const Grid& grid, MazePath& out) const
+{
+	if (status == FOUND)
+		mazeTraceBack(grid, [this](size_t cell) { return parent.get(cell); }, out);
+	else
+		out.reset(grid.entranceRow, grid.entranceCol);
+}
@@ -0,0 +1,221 @@
+/*
+
+	mazeBfs.h
+
+	Breadth-first search for the shortest path from the entrance to the exit.
+
+	Per cell the search keeps one visited bit and the two-bit direction it
+	was entered from, which is enough to walk the path back from the exit.
+	The queue is a ring buffer that only grows to the widest frontier seen,
+	which for a maze is far smaller than the grid. All buffers are kept for
+	the next solve.
+
+	The search can also run in pieces: start() sets it up and step()
+	expands a bounded number of cells, keeping all its state in the object
+	between calls. solve() is start() and one step() that runs to the end.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mazeBitset.h"
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+// FIFO of cell indices in a power-of-two ring buffer
+class MazeCellQueue {
+
+public:
+
+	MazeCellQueue() : head(0), tail(0), mask(0) {}
+
+	void reset(size_t capacity) {
+		size_t n = 64;
+		while (n < capacity) n *= 2;
+		if (buffer.size() < n)
+			buffer.resize(n);
+		mask = buffer.size() - 1;
+		head = tail = 0;
+	}
+
+	bool empty() const { return head == tail; }
+	size_t size() const { return tail - head; }
+
+	void push(uint64_t cell) {
+		if (tail - head == buffer.size())
+			grow();
+		buffer[tail++ & mask] = cell;
+	}
+	uint64_t pop() { return buffer[head++ & mask]; }
+
+	size_t memoryBytes() const { return buffer.capacity() * sizeof(uint64_t); }
+
+private:
+
+	// Double the buffer and unwrap the queue to its front
+	void grow() {
+		std::vector<uint64_t> bigger(buffer.size() * 2);
+		size_t n = tail - head;
+		for (size_t i = 0; i < n; i++)
+			bigger[i] = buffer[(head + i) & mask];
+		buffer.swap(bigger);
+		mask = buffer.size() - 1;
+		head = 0;
+		tail = n;
+	}
+
+	std::vector<uint64_t> buffer;
+	size_t head, tail; // running counts, wrapped with mask on access
+	size_t mask;
+
+};
+
+class MazeBfs {
+
+public:
+
+	MazeBfs() : expanded(0), opened(nullptr), closed(nullptr), status(IDLE), W(0), H(0), goal(0) {}
+
+	// Find a shortest path from the entrance to the exit. Returns false if
+	// there is none, in which case path is left empty.
+	template <class Grid>
+	bool solve(const Grid& grid, MazePath& path);
+
+	// Set up a search from the entrance to the exit
+	template <class Grid>
+	void start(const Grid& grid);
+
+	// Expand up to maxSteps more cells. Returns true while the search has
+	// more to do. grid must not change while it runs.
+	template <class Grid>
+	bool step(const Grid& grid, size_t maxSteps);
+
+	// Abandon the search
+	void stop() { status = IDLE; }
+
+	bool running() const { return status == RUNNING; }
+	bool done() const { return status == FOUND || status == FAILED; }
+	bool found() const { return status == FOUND; }
+
+	// Fill out with the path found, or leave it empty if there is none
+	template <class Grid>
+	void path(const Grid& grid, MazePath& out) const;
+
+	// Cells taken off the queue by the last solve, or so far
+	size_t expanded;
+
+	// When set, step() appends each cell it queues to opened and each cell
+	// it takes off the queue to closed
+	std::vector<uint64_t>* opened;
+	std::vector<uint64_t>* closed;
+
+	// Watched by solve, which stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const {
+		return visited.memoryBytes() + parent.memoryBytes() + queue.memoryBytes();
+	}
+
+private:
+
+	enum Status { IDLE, RUNNING, FOUND, FAILED };
+
+	Status status;
+	int W, H;
+	size_t goal;
+	MazeBitset visited;
+	MazeDirArray parent; // direction each cell was entered by
+	MazeCellQueue queue;
+
+};
+
+template <class Grid>
+bool MazeBfs::solve(const Grid& grid, MazePath& path)
+{
+	start(grid);
+	step(grid, SIZE_MAX);
+	bool ok = found();
+	this->path(grid, path);
+	stop();
+	return ok;
+}
+
+template <class Grid>
+void MazeBfs::start(const Grid& grid)
+{
+	expanded = 0;
+	if (grid.empty()) {
+		status = FAILED;
+		return;
+	}
+
+	H = grid.height();
+	W = grid.width();
+	size_t cells = grid.cellCount();
+	visited.reset(cells);
+	parent.reset(cells);
+	queue.reset(4 * ((size_t)H + W));
+
+	size_t source = grid.index(grid.entranceRow, grid.entranceCol);
+	goal = grid.index(grid.exitRow, grid.exitCol);
+	visited.set(source);
+	queue.push(source);
+	status = RUNNING;
+	if (opened)
+		opened->push_back(source);
+}
+
+template <class Grid>
+bool MazeBfs::step(const Grid& grid, size_t maxSteps)
+{
+	if (status != RUNNING)
+		return false;
+	for (size_t n = 0; n < maxSteps; n++) {
+		if (queue.empty()) {
+			status = FAILED;
+			return false;
+		}
+		if (cancel.poll()) {
+			status = IDLE;
+			return false;
+		}
+		size_t cur = queue.pop();
+		expanded++;
+		if (closed)
+			closed->push_back(cur);
+		if (cur == goal) {
+			status = FOUND;
+			return false;
+		}
+		int row = (int)(cur / W);
+		int col = (int)(cur % W);
+		for (int dir = 0; dir < 4; dir++) {
+			if (!grid.canMove(row, col, dir))
+				continue;
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr < 0 || nr >= H || nc < 0 || nc >= W)
+				continue;
+			size_t next = grid.index(nr, nc);
+			if (visited.testAndSet(next))
+				continue;
+			parent.set(next, dir);
+			queue.push(next);
+			if (opened)
+				opened->push_back(next);
+		}
+	}
+	return true;
+}
+
+template <class Grid>
+void MazeBfs::path(const Grid& grid, MazePath& out) const
+{
+	if (status == FOUND)
+		mazeTraceBack(grid, [this](size_t cell) { return parent.get(cell); }, out);
+	else
+		out.reset(grid.entranceRow, grid.entranceCol);
+}
@@ -0,0 +1,355 @@
+/*
+
+	mazeBidirectional.h
+
+	Bidirectional breadth-first search and A* from the entrance and the
+	exit at once, meeting in the middle.
+
+	Each side has its own visited bitset and two-bit parent directions. The
+	backward side stores the direction it stepped in, so following it from
+	the meeting cell walks forward to the exit. The path is stitched from
+	the two halves at the meeting cell.
+
+	MazeBiBfs expands the smaller frontier one level at a time and stops at
+	the first cell both sides have reached. On open mazes each side only
+	covers a disc of half the radius, about half the cells of a one-sided
+	search.
+
+	MazeBiAstar runs A* on each side toward the other end, always advancing
+	the side with fewer open cells. Both sides order cells by g plus the
+	balanced potential (distance to the target - distance to the source) / 2,
+	which is the negative of the other side's, so the sum of the two lowest
+	keys bounds every path not yet found and the search stops once it
+	reaches the best path through a meeting cell. A side never expands a
+	cell the other side has closed, since the other side has already searched
+	on from it. Keys are kept doubled to stay integers, and as a step changes
+	them by 0, 2 or 4 the open list is three buckets. Each side keeps a g
+	score per cell, since the meeting cost needs the other side's.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "mazeBfs.h"
+#include "mazeBitset.h"
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+// Fill path with the steps from the entrance to meet, by following the
+// forward parents back from meet, then from meet to the exit by following
+// the backward directions.
+template <class Grid>
+void mazeStitch(const Grid& grid, size_t meet, const MazeDirArray& forward, const MazeDirArray& backward, MazePath& path)
+{
+	int W = grid.width();
+	int meetRow = (int)(meet / W), meetCol = (int)(meet % W);
+
+	size_t head = 0;
+	for (int row = meetRow, col = meetCol; row != grid.entranceRow || col != grid.entranceCol; head++) {
+		int dir = forward.get(grid.index(row, col));
+		row -= MAZE_DROW[dir];
+		col -= MAZE_DCOL[dir];
+	}
+	size_t tail = 0;
+	for (int row = meetRow, col = meetCol; row != grid.exitRow || col != grid.exitCol; tail++) {
+		int dir = mazeOpposite(backward.get(grid.index(row, col)));
+		row += MAZE_DROW[dir];
+		col += MAZE_DCOL[dir];
+	}
+
+	path.reset(grid.entranceRow, grid.entranceCol);
+	path.resize(head + tail);
+	int row = meetRow, col = meetCol;
+	for (size_t i = head; i > 0; i--) {
+		int dir = forward.get(grid.index(row, col));
+		path.set(i - 1, dir);
+		row -= MAZE_DROW[dir];
+		col -= MAZE_DCOL[dir];
+	}
+	row = meetRow;
+	col = meetCol;
+	for (size_t i = head; i < head + tail; i++) {
+		int dir = mazeOpposite(backward.get(grid.index(row, col)));
+		path.set(i, dir);
+		row += MAZE_DROW[dir];
+		col += MAZE_DCOL[dir];
+	}
+}
+
+class MazeBiBfs {
+
+public:
+
+	MazeBiBfs() : expanded(0) {}
+
+	// Find a shortest path from the entrance to the exit. Returns false if
+	// there is none, in which case path is left empty.
+	template <class Grid>
+	bool solve(const Grid& grid, MazePath& path);
+
+	// Cells taken off either queue by the last solve
+	size_t expanded;
+
+	// Watched by solve, which stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const {
+		size_t bytes = 0;
+		for (int s = 0; s < 2; s++)
+			bytes += side[s].visited.memoryBytes() + side[s].parent.memoryBytes() + side[s].queue.memoryBytes();
+		return bytes;
+	}
+
+private:
+
+	struct Side {
+		MazeBitset visited;
+		MazeDirArray parent;
+		MazeCellQueue queue;
+	};
+
+	// Expand one level of side s. Returns the first cell the other side has
+	// already reached, or SIZE_MAX if the frontiers did not touch.
+	template <class Grid>
+	size_t expandLevel(const Grid& grid, int s);
+
+	Side side[2]; // 0 from the entrance, 1 from the exit
+
+};
+
+template <class Grid>
+size_t MazeBiBfs::expandLevel(const Grid& grid, int s)
+{
+	int H = grid.height();
+	int W = grid.width();
+	Side& me = side[s];
+	const Side& other = side[1 - s];
+
+	for (size_t n = me.queue.size(); n > 0; n--) {
+		size_t cur = me.queue.pop();
+		expanded++;
+		int row = (int)(cur / W);
+		int col = (int)(cur % W);
+		for (int dir = 0; dir < 4; dir++) {
+			if (!grid.canMove(row, col, dir))
+				continue;
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr < 0 || nr >= H || nc < 0 || nc >= W)
+				continue;
+			size_t next = grid.index(nr, nc);
+			if (me.visited.testAndSet(next))
+				continue;
+			me.parent.set(next, dir);
+			me.queue.push(next);
+			// The first touch is on the other side's unexpanded frontier,
+			// which is all one depth, so any meeting cell is on a shortest path
+			if (other.visited.test(next))
+				return next;
+		}
+	}
+	return SIZE_MAX;
+}
+
+template <class Grid>
+bool MazeBiBfs::solve(const Grid& grid, MazePath& path)
+{
+	expanded = 0;
+	path.reset(grid.entranceRow, grid.entranceCol);
+	if (grid.empty())
+		return false;
+
+	int H = grid.height();
+	int W = grid.width();
+	size_t cells = grid.cellCount();
+	size_t ends[2] = { grid.index(grid.entranceRow, grid.entranceCol), grid.index(grid.exitRow, grid.exitCol) };
+	if (ends[0] == ends[1])
+		return true;
+	for (int s = 0; s < 2; s++) {
+		side[s].visited.reset(cells);
+		side[s].parent.reset(cells);
+		side[s].queue.reset(2 * ((size_t)H + W));
+		side[s].visited.set(ends[s]);
+		side[s].queue.push(ends[s]);
+	}
+
+	size_t meet = SIZE_MAX;
+	while (meet == SIZE_MAX && !side[0].queue.empty() && !side[1].queue.empty()) {
+		// A level is at most a frontier, so checking between levels is enough
+		if (cancel.now())
+			return false;
+		meet = expandLevel(grid, side[0].queue.size() <= side[1].queue.size() ? 0 : 1);
+	}
+	if (meet == SIZE_MAX)
+		return false;
+
+	mazeStitch(grid, meet, side[0].parent, side[1].parent, path);
+	return true;
+}
+
+class MazeBiAstar {
+
+public:
+
+	MazeBiAstar() : expanded(0) {}
+
+	// Find a shortest path from the entrance to the exit. Returns false if
+	// there is none, in which case path is left empty.
+	template <class Grid>
+	bool solve(const Grid& grid, MazePath& path);
+
+	// Cells closed by either side in the last solve
+	size_t expanded;
+
+	// Watched by solve, which stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const {
+		size_t bytes = 0;
+		for (int s = 0; s < 2; s++) {
+			bytes += side[s].g.capacity() * sizeof(uint32_t) + side[s].closed.memoryBytes() + side[s].parent.memoryBytes();
+			for (int b = 0; b < 3; b++)
+				bytes += side[s].bucket[b].capacity() * sizeof(uint64_t);
+		}
+		return bytes;
+	}
+
+private:
+
+	struct Side {
+		std::vector<uint32_t> g; // UINT32_MAX until reached
+		MazeBitset closed;
+		MazeDirArray parent;
+		// Open cells by key: bucket[F / 2 % 3] holds key F, the next two
+		// buckets keys F + 2 and F + 4
+		std::vector<uint64_t> bucket[3];
+		size_t F;
+		int sourceRow, sourceCol; // end this side starts from
+		int targetRow, targetCol; // end it searches toward
+	};
+
+	// Twice the side's balanced potential of a cell plus twice g
+	static size_t key(const Side& me, int row, int col, uint32_t g) {
+		int toTarget = abs(row - me.targetRow) + abs(col - me.targetCol);
+		int toSource = abs(row - me.sourceRow) + abs(col - me.sourceCol);
+		return (size_t)((int64_t)2 * g + toTarget - toSource);
+	}
+
+	// Move to the next bucket when the current one holds no live cells.
+	// Returns false if the side has nothing left open.
+	template <class Grid>
+	bool settle(const Grid& grid, Side& me);
+
+	Side side[2]; // 0 from the entrance toward the exit, 1 the other way
+
+};
+
+template <class Grid>
+bool MazeBiAstar::settle(const Grid& grid, Side& me)
+{
+	int W = grid.width();
+	for (;;) {
+		std::vector<uint64_t>& open = me.bucket[me.F / 2 % 3];
+		while (!open.empty()) {
+			size_t cell = open.back();
+			if (!me.closed.test(cell) && key(me, (int)(cell / W), (int)(cell % W), me.g[cell]) == me.F)
+				return true;
+			open.pop_back();
+		}
+		if (me.bucket[0].empty() && me.bucket[1].empty() && me.bucket[2].empty())
+			return false;
+		me.F += 2;
+	}
+}
+
+template <class Grid>
+bool MazeBiAstar::solve(const Grid& grid, MazePath& path)
+{
+	expanded = 0;
+	path.reset(grid.entranceRow, grid.entranceCol);
+	if (grid.empty())
+		return false;
+
+	int H = grid.height();
+	int W = grid.width();
+	size_t cells = grid.cellCount();
+	int endRow[2] = { grid.entranceRow, grid.exitRow };
+	int endCol[2] = { grid.entranceCol, grid.exitCol };
+	if (endRow[0] == endRow[1] && endCol[0] == endCol[1])
+		return true;
+	for (int s = 0; s < 2; s++) {
+		Side& me = side[s];
+		me.g.assign(cells, UINT32_MAX);
+		me.closed.reset(cells);
+		me.parent.reset(cells);
+		for (int b = 0; b < 3; b++)
+			me.bucket[b].clear();
+		me.sourceRow = endRow[s];
+		me.sourceCol = endCol[s];
+		me.targetRow = endRow[1 - s];
+		me.targetCol = endCol[1 - s];
+		size_t start = grid.index(endRow[s], endCol[s]);
+		me.g[start] = 0;
+		me.F = key(me, endRow[s], endCol[s], 0);
+		me.bucket[me.F / 2 % 3].push_back(start);
+	}
+
+	size_t best = SIZE_MAX;
+	size_t meet = SIZE_MAX;
+
+	while (settle(grid, side[0]) && settle(grid, side[1])) {
+		if (cancel.poll())
+			return false;
+		// The potentials of the two sides cancel on every cell, so half the
+		// sum of the lowest keys bounds any path not found yet
+		if (best != SIZE_MAX && side[0].F + side[1].F >= 2 * best)
+			break;
+		size_t open0 = side[0].bucket[0].size() + side[0].bucket[1].size() + side[0].bucket[2].size();
+		size_t open1 = side[1].bucket[0].size() + side[1].bucket[1].size() + side[1].bucket[2].size();
+		int s = open0 <= open1 ? 0 : 1;
+		Side& me = side[s];
+		const Side& other = side[1 - s];
+
+		size_t cur = me.bucket[me.F / 2 % 3].back();
+		me.bucket[me.F / 2 % 3].pop_back();
+		if (other.closed.test(cur))
+			continue;
+		me.closed.set(cur);
+		expanded++;
+
+		int row = (int)(cur / W);
+		int col = (int)(cur % W);
+		uint32_t ng = me.g[cur] + 1;
+		for (int dir = 0; dir < 4; dir++) {
+			if (!grid.canMove(row, col, dir))
+				continue;
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr < 0 || nr >= H || nc < 0 || nc >= W)
+				continue;
+			size_t next = grid.index(nr, nc);
+			if (me.closed.test(next) || ng >= me.g[next])
+				continue;
+			me.g[next] = ng;
+			me.parent.set(next, dir);
+			if (other.g[next] != UINT32_MAX && ng + other.g[next] < best) {
+				best = ng + other.g[next];
+				meet = next;
+			}
+			// The other side has already searched on from a cell it closed
+			if (other.closed.test(next))
+				continue;
+			size_t k = key(me, nr, nc, ng);
+			me.bucket[k / 2 % 3].push_back(next);
+		}
+	}
+	if (meet == SIZE_MAX)
+		return false;
+
+	mazeStitch(grid, meet, side[0].parent, side[1].parent, path);
+	return true;
+}
@@ -0,0 +1,179 @@
+/*
+
+	mazeBinary.cpp
+
+*/
+#include "mazeBinary.h"
+#include "mazeLoader.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char MAZE_BIN_MAGIC[4] = { 'M', 'A', 'Z', 'B' };
+
+static bool fail(std::string* error, const char* msg)
+{
+	if (error) *error = msg;
+	return false;
+}
+
+bool isMazeBin(const char* data, size_t size)
+{
+	return size >= MAZE_BIN_HEADER_BYTES && memcmp(data, MAZE_BIN_MAGIC, 4) == 0;
+}
+
+void mazeBinEncodeHeader(const MazeBinHeader& header, uint8_t out[MAZE_BIN_HEADER_BYTES])
+{
+	memcpy(out, header.magic, 4);
+	mazePut16(out + 4, header.version);
+	mazePut16(out + 6, header.headerSize);
+	mazePut32(out + 8, header.height);
+	mazePut32(out + 12, header.width);
+	mazePut32(out + 16, header.entranceRow);
+	mazePut32(out + 20, header.entranceCol);
+	mazePut32(out + 24, header.exitRow);
+	mazePut32(out + 28, header.exitCol);
+}
+
+void mazeBinDecodeHeader(const uint8_t in[MAZE_BIN_HEADER_BYTES], MazeBinHeader& header)
+{
+	memcpy(header.magic, in, 4);
+	header.version = mazeGet16(in + 4);
+	header.headerSize = mazeGet16(in + 6);
+	header.height = mazeGet32(in + 8);
+	header.width = mazeGet32(in + 12);
+	header.entranceRow = mazeGet32(in + 16);
+	header.entranceCol = mazeGet32(in + 20);
+	header.exitRow = mazeGet32(in + 24);
+	header.exitCol = mazeGet32(in + 28);
+}
+
+MazeBinHeader mazeBinHeader(int height, int width)
+{
+	MazeBinHeader header;
+	memcpy(header.magic, MAZE_BIN_MAGIC, 4);
+	header.version = MAZE_BIN_VERSION;
+	header.headerSize = MAZE_BIN_HEADER_BYTES;
+	header.height = height;
+	header.width = width;
+	header.entranceRow = 0;
+	header.entranceCol = 0;
+	header.exitRow = height > 0 ? height - 1 : 0;
+	header.exitCol = width > 0 ? width - 1 : 0;
+	return header;
+}
+
+//--------------------------------------------------------------
+MazeBinView::MazeBinView()
+{
+	cells = nullptr;
+	rowBytes = 0;
+	HEIGHT = 0;
+	WIDTH = 0;
+	entranceRow = entranceCol = 0;
+	exitRow = exitCol = 0;
+}
+
+bool MazeBinView::open(const std::string& path, std::string* error)
+{
+	close();
+	if (!file.open(path))
+		return fail(error, "cannot open file");
+	if (!isMazeBin(file.data(), file.size())) {
+		close();
+		return fail(error, "not a binary maze file");
+	}
+
+	MazeBinHeader header;
+	mazeBinDecodeHeader((const uint8_t*)file.data(), header);
+	if (header.version != MAZE_BIN_VERSION || header.headerSize < MAZE_BIN_HEADER_BYTES) {
+		close();
+		return fail(error, "unsupported binary maze version");
+	}
+
+	size_t bytes = (size_t)header.height * ((header.width + 1) / 2);
+	if (header.height > INT32_MAX || header.width > INT32_MAX
+		|| file.size() < header.headerSize + bytes
+		|| header.entranceRow >= header.height || header.exitRow >= header.height
+		|| header.entranceCol >= header.width || header.exitCol >= header.width) {
+		close();
+		return fail(error, "corrupt binary maze header");
+	}
+
+	HEIGHT = (int)header.height;
+	WIDTH = (int)header.width;
+	rowBytes = (WIDTH + 1) / 2;
+	cells = (const uint8_t*)file.data() + header.headerSize;
+	entranceRow = (int)header.entranceRow;
+	entranceCol = (int)header.entranceCol;
+	exitRow = (int)header.exitRow;
+	exitCol = (int)header.exitCol;
+	return true;
+}
+
+void MazeBinView::close()
+{
+	file.close();
+	cells = nullptr;
+	rowBytes = 0;
+	HEIGHT = 0;
+	WIDTH = 0;
+}
+
+//--------------------------------------------------------------
+bool saveMazBin(const MazeGrid& grid, const std::string& path, std::string* error)
+{
+	// A 0 x 0 header would not load back
+	if (grid.empty())
+		return fail(error, "empty maze");
+	FILE* fp = fopen(path.c_str(), "wb");
+	if (!fp)
+		return fail(error, "cannot create file");
+
+	MazeBinHeader header = mazeBinHeader(grid.height(), grid.width());
+	header.entranceRow = grid.entranceRow;
+	header.entranceCol = grid.entranceCol;
+	header.exitRow = grid.exitRow;
+	header.exitCol = grid.exitCol;
+	uint8_t bytes[MAZE_BIN_HEADER_BYTES];
+	mazeBinEncodeHeader(header, bytes);
+	bool ok = fwrite(bytes, 1, sizeof(bytes), fp) == sizeof(bytes);
+
+	std::vector<uint8_t> row((grid.width() + 1) / 2);
+	for (int i = 0; ok && i < grid.height(); i++) {
+		std::fill(row.begin(), row.end(), 0);
+		for (int j = 0; j < grid.width(); j++)
+			row[j >> 1] |= (uint8_t)(grid.walls(i, j) << ((j & 1) * 4));
+		ok = fwrite(row.data(), 1, row.size(), fp) == row.size();
+	}
+
+	if (fclose(fp) != 0) ok = false;
+	return ok || fail(error, "write failed");
+}
+
+bool loadMazBin(const std::string& path, MazeGrid& grid, std::string* error, MazeLoadProgress* progress)
+{
+	MazeBinView view;
+	if (!view.open(path, error)) {
+		grid.reset();
+		return false;
+	}
+
+	if (progress)
+		progress->bytesTotal.store(view.fileSize(), std::memory_order_relaxed);
+	grid.resize(view.height(), view.width());
+	for (int i = 0; i < view.height(); i++) {
+		for (int j = 0; j < view.width(); j++)
+			grid.setWalls(i, j, view.walls(i, j));
+		if (progress && !progress->update(view.rowOffset(i + 1))) {
+			grid.reset();
+			return fail(error, "load cancelled");
+		}
+	}
+	grid.entranceRow = view.entranceRow;
+	grid.entranceCol = view.entranceCol;
+	grid.exitRow = view.exitRow;
+	grid.exitCol = view.exitCol;
+	return true;
+}
@@ -0,0 +1,117 @@
+/*
+
+	mazeBinary.h
+
+	Binary maze format (.mazb)
+
+	32 byte little-endian header followed by the WALL_* flags of every cell,
+	two cells per byte (even column in the low nibble). Each row starts on
+	a byte boundary, so a row takes (width + 1) / 2 bytes.
+
+	MazeBinView maps the file and reads the flags in place, so opening a
+	file costs one mmap and no decoding.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "mazeGrid.h"
+#include "mazeMappedFile.h"
+
+struct MazeLoadProgress;
+
+#define MAZE_BIN_VERSION 1
+
+struct MazeBinHeader {
+	char magic[4]; // "MAZB"
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t height;
+	uint32_t width;
+	uint32_t entranceRow, entranceCol;
+	uint32_t exitRow, exitCol;
+};
+
+// Size of the header in a file
+#define MAZE_BIN_HEADER_BYTES 32
+
+// Little-endian fields of the file headers, whatever the byte order of the host
+inline void mazePut16(uint8_t* p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+inline void mazePut32(uint8_t* p, uint32_t v)
+{
+	for (int i = 0; i < 4; i++)
+		p[i] = (uint8_t)(v >> (i * 8));
+}
+
+inline uint16_t mazeGet16(const uint8_t* p)
+{
+	return (uint16_t)(p[0] | p[1] << 8);
+}
+
+inline uint32_t mazeGet32(const uint8_t* p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// True if the data starts with a binary maze header
+bool isMazeBin(const char* data, size_t size);
+
+// Header for a height x width maze with the default entrance and exit
+MazeBinHeader mazeBinHeader(int height, int width);
+
+// The header as stored in a file, field by field in little-endian order
+// whatever the byte order of the host
+void mazeBinEncodeHeader(const MazeBinHeader& header, uint8_t out[MAZE_BIN_HEADER_BYTES]);
+void mazeBinDecodeHeader(const uint8_t in[MAZE_BIN_HEADER_BYTES], MazeBinHeader& header);
+
+// Read-only view of a mapped .mazb file
+class MazeBinView {
+
+public:
+
+	MazeBinView();
+
+	bool open(const std::string& path, std::string* error = nullptr);
+	void close();
+
+	bool empty() const { return HEIGHT == 0 || WIDTH == 0; }
+	int height() const { return HEIGHT; }
+	int width() const { return WIDTH; }
+	size_t cellCount() const { return (size_t)HEIGHT * WIDTH; }
+	size_t index(int row, int col) const { return (size_t)row * WIDTH + col; }
+
+	int walls(int row, int col) const {
+		return (cells[(size_t)row * rowBytes + (col >> 1)] >> ((col & 1) * 4)) & 0xF;
+	}
+	bool canMove(int row, int col, int dir) const { return (walls(row, col) & mazeWallFlag(dir)) == 0; }
+
+	// File size, and the file offset where cell row row starts
+	size_t fileSize() const { return file.size(); }
+	size_t rowOffset(int row) const { return (size_t)((const char*)cells - file.data()) + (size_t)row * rowBytes; }
+
+	int entranceRow, entranceCol;
+	int exitRow, exitCol;
+
+private:
+
+	MazeMappedFile file;
+	const uint8_t* cells;
+	size_t rowBytes;
+	int HEIGHT;
+	int WIDTH;
+
+};
+
+// Write grid as .mazb. Fails if grid is empty.
+bool saveMazBin(const MazeGrid& grid, const std::string& path, std::string* error = nullptr);
+
+// Load a .mazb file into grid, reporting to progress (see mazeLoader.h)
+bool loadMazBin(const std::string& path, MazeGrid& grid, std::string* error = nullptr,
+	MazeLoadProgress* progress = nullptr);
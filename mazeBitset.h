@@ -0,0 +1,114 @@
+/*
+
+	mazeBitset.h
+
+	One bit per cell, used for visited sets.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Number of set bits in a word
+inline int mazePopcount(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest and highest set bit of a nonzero word
+inline int mazeLowBit(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+	unsigned long i;
+	_BitScanForward(&i, x);
+	return (int)i;
+#else
+	int i = 0;
+	while (!(x & 1)) { x >>= 1; i++; }
+	return i;
+#endif
+}
+
+inline int mazeLowBit64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long i;
+	_BitScanForward64(&i, x);
+	return (int)i;
+#else
+	return (uint32_t)x ? mazeLowBit((uint32_t)x) : 32 + mazeLowBit((uint32_t)(x >> 32));
+#endif
+}
+
+inline int mazeHighBit(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return 31 - __builtin_clz(x);
+#elif defined(_MSC_VER)
+	unsigned long i;
+	_BitScanReverse(&i, x);
+	return (int)i;
+#else
+	int i = 0;
+	while (x >>= 1) i++;
+	return i;
+#endif
+}
+
+class MazeBitset {
+
+public:
+
+	MazeBitset() : count(0) {}
+
+	// Size for n bits and clear them. Keeps the buffer if it is big enough.
+	void reset(size_t n) {
+		count = n;
+		size_t words = (n + 63) / 64;
+		if (bits.size() < words)
+			bits.resize(words);
+		memset(bits.data(), 0, words * sizeof(uint64_t));
+	}
+
+	bool test(size_t i) const { return (bits[i >> 6] >> (i & 63)) & 1; }
+	void set(size_t i) { bits[i >> 6] |= 1ULL << (i & 63); }
+	void unset(size_t i) { bits[i >> 6] &= ~(1ULL << (i & 63)); }
+
+	// Set bit i and return whether it was already set
+	bool testAndSet(size_t i) {
+		uint64_t mask = 1ULL << (i & 63);
+		uint64_t old = bits[i >> 6];
+		bits[i >> 6] = old | mask;
+		return (old & mask) != 0;
+	}
+
+	size_t size() const { return count; }
+	uint64_t* words() { return bits.data(); }
+	const uint64_t* words() const { return bits.data(); }
+	size_t memoryBytes() const { return bits.capacity() * sizeof(uint64_t); }
+
+private:
+
+	std::vector<uint64_t> bits;
+	size_t count;
+
+};
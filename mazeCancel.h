@@ -0,0 +1,46 @@
+/*
+
+	mazeCancel.h
+
+	Lets another thread stop a search engine part way through.
+
+	Each engine has a MazeCancel that its main loop polls once per cell.
+	poll() only loads the flag every few thousand calls, so the check costs
+	a counter decrement. A stopped engine returns false with an empty path,
+	as if there were no path; the caller tells the two apart by its flag.
+
+*/
+#pragma once
+
+#include <atomic>
+
+class MazeCancel {
+
+public:
+
+	MazeCancel() : flag(nullptr), countdown(POLL) {}
+
+	// Stop when flag turns true, or never with nullptr. flag must outlive
+	// every solve started while it is watched.
+	void watch(const std::atomic<bool>* f) { flag = f; countdown = POLL; }
+
+	// True if the flag is set, looked at every POLL calls
+	bool poll()
+	{
+		if (--countdown > 0)
+			return false;
+		countdown = POLL;
+		return now();
+	}
+
+	// Look at the flag straight away, for loops with few, long iterations
+	bool now() const { return flag && flag->load(std::memory_order_relaxed); }
+
+private:
+
+	enum { POLL = 4096 };
+
+	const std::atomic<bool>* flag;
+	int countdown;
+
+};
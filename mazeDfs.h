@@ -0,0 +1,203 @@
+/*
+
+	mazeDfs.h
+
+	Iterative depth-first search from the entrance to the exit.
+
+	The search stack is the path itself: one direction per step, two bits
+	each, so the cell of every stack frame is recomputed from its parent
+	while backtracking and the next direction to try is the popped one
+	plus one. The visited set takes one bit per cell. Both buffers are
+	sized before the search starts and kept for the next solve, so the
+	search never allocates and never recurses.
+
+	The search can also run in pieces: start() sets it up and step()
+	advances it, keeping all its state in the object between calls. solve()
+	is start() and one step() that runs to the end.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mazeBitset.h"
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeDfs {
+
+public:
+
+	MazeDfs() : expanded(0), opened(nullptr), closed(nullptr), status(IDLE), H(0), W(0), row(0), col(0), dir(0) {}
+
+	// Find a path from the entrance to the exit. Returns false if there is
+	// none, in which case path is left empty.
+	template <class Grid>
+	bool solve(const Grid& grid, MazePath& path);
+
+	// Set up a search from the entrance to the exit
+	template <class Grid>
+	void start(const Grid& grid);
+
+	// Advance the search by up to maxSteps moves forward or back. Returns
+	// true while it has more to do. grid must not change while it runs.
+	template <class Grid>
+	bool step(const Grid& grid, size_t maxSteps);
+
+	// Abandon the search
+	void stop() { status = IDLE; }
+
+	bool running() const { return status == RUNNING; }
+	bool done() const { return status == FOUND || status == FAILED; }
+	bool found() const { return status == FOUND; }
+
+	// Copy the path found into out, or leave out empty if there is none
+	template <class Grid>
+	void path(const Grid& grid, MazePath& out) const;
+	// The same, but the path is swapped out of the search rather than
+	// copied. The search is stopped.
+	template <class Grid>
+	void takePath(const Grid& grid, MazePath& out);
+
+	// Cells visited by the last solve, or so far
+	size_t expanded;
+
+	// When set, step() appends each cell it moves into to opened and each
+	// cell it backs out of to closed
+	std::vector<uint64_t>* opened;
+	std::vector<uint64_t>* closed;
+
+	// Watched by solve, which stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const { return visited.memoryBytes() + stack.memoryBytes(); }
+
+private:
+
+	enum Status { IDLE, RUNNING, FOUND, FAILED };
+
+	Status status;
+	int H, W;
+	MazeBitset visited;
+	MazePath stack; // the path so far; (row, col) is its end
+	int row, col, dir; // dir is the next direction to try from (row, col)
+
+};
+
+template <class Grid>
+bool MazeDfs::solve(const Grid& grid, MazePath& path)
+{
+	start(grid);
+	step(grid, SIZE_MAX);
+	bool ok = found();
+	takePath(grid, path);
+	return ok;
+}
+
+template <class Grid>
+void MazeDfs::start(const Grid& grid)
+{
+	expanded = 0;
+	stack.reset(grid.entranceRow, grid.entranceCol);
+	if (grid.empty()) {
+		status = FAILED;
+		return;
+	}
+
+	H = grid.height();
+	W = grid.width();
+	visited.reset(grid.cellCount());
+	stack.reserve(grid.cellCount());
+
+	row = grid.entranceRow;
+	col = grid.entranceCol;
+	dir = 0;
+	size_t source = grid.index(row, col);
+	visited.set(source);
+	expanded = 1;
+	status = RUNNING;
+	if (opened)
+		opened->push_back(source);
+}
+
+template <class Grid>
+bool MazeDfs::step(const Grid& grid, size_t maxSteps)
+{
+	if (status != RUNNING)
+		return false;
+	// Work on locals, which the compiler can keep in registers, and store
+	// them back when the step ends
+	int H = this->H, W = this->W;
+	int row = this->row, col = this->col, dir = this->dir;
+	size_t n = 0;
+	for (; n < maxSteps; n++) {
+		if (row == grid.exitRow && col == grid.exitCol) {
+			status = FOUND;
+			break;
+		}
+		if (cancel.poll()) {
+			status = IDLE;
+			break;
+		}
+
+		// Next open, unvisited neighbour starting from dir
+		for (; dir < 4; dir++) {
+			if (!grid.canMove(row, col, dir))
+				continue;
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr < 0 || nr >= H || nc < 0 || nc >= W)
+				continue;
+			if (!visited.testAndSet(grid.index(nr, nc)))
+				break;
+		}
+
+		if (dir < 4) {
+			stack.push(dir);
+			row += MAZE_DROW[dir];
+			col += MAZE_DCOL[dir];
+			dir = 0;
+			expanded++;
+			if (opened)
+				opened->push_back(grid.index(row, col));
+		}
+		else {
+			// Dead end: step back and try the parent's next direction
+			if (closed)
+				closed->push_back(grid.index(row, col));
+			if (stack.empty()) {
+				status = FAILED;
+				break;
+			}
+			int back = stack.pop();
+			row -= MAZE_DROW[back];
+			col -= MAZE_DCOL[back];
+			dir = back + 1;
+		}
+	}
+	this->row = row;
+	this->col = col;
+	this->dir = dir;
+	return status == RUNNING;
+}
+
+template <class Grid>
+void MazeDfs::path(const Grid& grid, MazePath& out) const
+{
+	if (status == FOUND)
+		out.assign(stack);
+	else
+		out.reset(grid.entranceRow, grid.entranceCol);
+}
+
+template <class Grid>
+void MazeDfs::takePath(const Grid& grid, MazePath& out)
+{
+	if (status == FOUND)
+		out.swap(stack);
+	else
+		out.reset(grid.entranceRow, grid.entranceCol);
+	stop();
+}
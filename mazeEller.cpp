@@ -0,0 +1,188 @@
+/*
+
+	mazeEller.cpp
+
+*/
+#include "mazeEller.h"
+#include <algorithm>
+#include <cstdio>
+#include "mazeBinary.h"
+
+MazeEller::MazeEller(int width, uint64_t seed) : random(seed)
+{
+	WIDTH = width > 0 ? width : 0;
+	row.assign(WIDTH, 0);
+	openUp.assign(WIDTH, 0);
+	set.assign(WIDTH, -1);
+	parent.assign(WIDTH, 0);
+	seen.assign(WIDTH, 0);
+	pick.assign(WIDTH, 0);
+	opened.assign(WIDTH, 0);
+	unused.reserve(WIDTH);
+}
+
+size_t MazeEller::memoryBytes() const
+{
+	return row.capacity() + openUp.capacity() + opened.capacity()
+		+ (set.capacity() + parent.capacity() + seen.capacity() + pick.capacity() + unused.capacity()) * sizeof(int);
+}
+
+int MazeEller::find(int s)
+{
+	while (parent[s] != s) {
+		parent[s] = parent[parent[s]];
+		s = parent[s];
+	}
+	return s;
+}
+
+const uint8_t* MazeEller::nextRow(bool last)
+{
+	int W = WIDTH;
+	if (W == 0)
+		return row.data();
+
+	// Cells not opened from above get set numbers nobody in the row uses
+	std::fill(opened.begin(), opened.end(), 0);
+	for (int j = 0; j < W; j++)
+		if (openUp[j])
+			opened[set[j]] = 1;
+	unused.clear();
+	for (int s = W - 1; s >= 0; s--)
+		if (!opened[s])
+			unused.push_back(s);
+	for (int j = 0; j < W; j++) {
+		if (!openUp[j]) {
+			set[j] = unused.back();
+			unused.pop_back();
+		}
+		parent[set[j]] = set[j];
+		row[j] = openUp[j] ? 0 : WALL_UP;
+	}
+	row[0] |= WALL_LEFT;
+	row[W - 1] |= WALL_RIGHT;
+
+	// Join neighbours of different sets, all of them on the last row
+	for (int j = 0; j + 1 < W; j++) {
+		int a = find(set[j]), b = find(set[j + 1]);
+		if (a != b && (last || random.coin())) {
+			parent[b] = a;
+		}
+		else {
+			row[j] |= WALL_RIGHT;
+			row[j + 1] |= WALL_LEFT;
+		}
+	}
+	for (int j = 0; j < W; j++)
+		set[j] = find(set[j]);
+
+	if (last) {
+		for (int j = 0; j < W; j++)
+			row[j] |= WALL_DOWN;
+		return row.data();
+	}
+
+	// Open downward at random, then once more in any set that did not open,
+	// at a cell picked uniformly from the set
+	std::fill(opened.begin(), opened.end(), 0);
+	std::fill(seen.begin(), seen.end(), 0);
+	for (int j = 0; j < W; j++) {
+		int s = set[j];
+		openUp[j] = random.coin();
+		opened[s] |= openUp[j];
+		seen[s]++;
+	}
+	for (int j = 0; j < W; j++) {
+		int s = set[j];
+		if (!opened[s] && seen[s] > 0) {
+			pick[s] = (int)random.below(seen[s]);
+			seen[s] = 0;
+		}
+	}
+	for (int j = 0; j < W; j++) {
+		int s = set[j];
+		if (!opened[s] && seen[s]++ == pick[s])
+			openUp[j] = 1;
+		if (!openUp[j])
+			row[j] |= WALL_DOWN;
+	}
+	return row.data();
+}
+
+//--------------------------------------------------------------
+bool generateMazeFile(const std::string& path, int height, int width, uint64_t seed, bool binary, std::string* error)
+{
+	if (height <= 0 || width <= 0) {
+		if (error) *error = "maze size must be positive";
+		return false;
+	}
+	FILE* fp = fopen(path.c_str(), "wb");
+	if (!fp) {
+		if (error) *error = "cannot create file";
+		return false;
+	}
+	std::vector<char> buffer(4 << 20);
+	setvbuf(fp, buffer.data(), _IOFBF, buffer.size());
+
+	MazeEller eller(width, seed);
+	bool ok = true;
+	if (binary) {
+		uint8_t header[MAZE_BIN_HEADER_BYTES];
+		mazeBinEncodeHeader(mazeBinHeader(height, width), header);
+		ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+		std::vector<uint8_t> line((width + 1) / 2);
+		for (int i = 0; ok && i < height; i++) {
+			const uint8_t* walls = eller.nextRow(i == height - 1);
+			std::fill(line.begin(), line.end(), 0);
+			for (int j = 0; j < width; j++)
+				line[j >> 1] |= (uint8_t)(walls[j] << ((j & 1) * 4));
+			ok = fwrite(line.data(), 1, line.size(), fp) == line.size();
+		}
+	}
+	else {
+		// Same layout as saveMaz: the wall line above each row, then the
+		// row itself, then the bottom border
+		std::string line(width * 2 + 2, ' ');
+		line[width * 2 + 1] = '\n';
+		for (int i = 0; ok && i < height; i++) {
+			const uint8_t* walls = eller.nextRow(i == height - 1);
+			for (int j = 0; j < width; j++) {
+				line[j * 2] = '+';
+				line[j * 2 + 1] = (walls[j] & WALL_UP) ? '-' : ' ';
+			}
+			line[width * 2] = '+';
+			ok = fwrite(line.data(), 1, line.size(), fp) == line.size();
+			for (int j = 0; j < width; j++) {
+				line[j * 2] = (walls[j] & WALL_LEFT) ? '|' : ' ';
+				line[j * 2 + 1] = ' ';
+			}
+			line[width * 2] = '|';
+			ok = ok && fwrite(line.data(), 1, line.size(), fp) == line.size();
+		}
+		for (int j = 0; ok && j < width; j++) {
+			line[j * 2] = '+';
+			line[j * 2 + 1] = '-';
+		}
+		line[width * 2] = '+';
+		ok = ok && fwrite(line.data(), 1, line.size(), fp) == line.size();
+	}
+
+	if (fclose(fp) != 0) ok = false;
+	if (!ok && error) *error = "write failed";
+	return ok;
+}
+
+void generateMaze(MazeGrid& grid, int height, int width, uint64_t seed)
+{
+	if (height <= 0 || width <= 0) {
+		grid.clear();
+		return;
+	}
+	grid.resize(height, width);
+	MazeEller eller(width, seed);
+	for (int i = 0; i < height; i++) {
+		const uint8_t* walls = eller.nextRow(i == height - 1);
+		for (int j = 0; j < width; j++)
+			grid.setWalls(i, j, walls[j]);
+	}
+}
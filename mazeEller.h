@@ -0,0 +1,107 @@
+/*
+
+	mazeEller.h
+
+	Perfect maze generation with Eller's algorithm, one row at a time.
+
+	Each row only needs the set every cell belongs to. Adjacent cells of
+	different sets are joined at random, then every set opens at least one
+	cell downward so no part of the maze is cut off; cells below with no
+	opening start new sets. The last row joins everything that is left.
+	The state is a few arrays of WIDTH entries, so the height is unbounded
+	and rows can be streamed to a file as they are made.
+
+	The random generator is a fixed xorshift, so a seed gives the same
+	maze on every platform.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mazeGrid.h"
+
+// Small seeded random generator (splitmix64 seeding, xorshift64*)
+class MazeRandom {
+
+public:
+
+	explicit MazeRandom(uint64_t seed = 1) { reseed(seed); }
+
+	void reseed(uint64_t seed) {
+		uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		state = (z ^ (z >> 31)) | 1;
+		bits = 0;
+		left = 0;
+	}
+
+	uint64_t next() {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1DULL;
+	}
+
+	// One fair coin flip, taken from a buffered word
+	bool coin() {
+		if (left == 0) {
+			bits = next();
+			left = 64;
+		}
+		left--;
+		bool b = bits & 1;
+		bits >>= 1;
+		return b;
+	}
+
+	// Uniform in 0 .. n - 1
+	uint32_t below(uint32_t n) { return (uint32_t)(((next() >> 32) * n) >> 32); }
+
+private:
+
+	uint64_t state;
+	uint64_t bits;
+	int left;
+
+};
+
+class MazeEller {
+
+public:
+
+	MazeEller(int width, uint64_t seed);
+
+	// Make the next row and return the WALL_* flags of its cells. last
+	// closes the maze: every set is joined and no cell opens downward.
+	const uint8_t* nextRow(bool last);
+
+	int width() const { return WIDTH; }
+
+	size_t memoryBytes() const;
+
+private:
+
+	int find(int set);
+
+	int WIDTH;
+	MazeRandom random;
+	std::vector<uint8_t> row; // WALL_* flags of the current row
+	std::vector<uint8_t> openUp; // 1 where the row above opened downward
+	std::vector<int> set; // set of each cell
+	std::vector<int> parent; // union-find over set numbers within a row
+	std::vector<int> seen, pick; // per set: cells seen, cell chosen to open down
+	std::vector<uint8_t> opened; // per set: a cell opens downward
+	std::vector<int> unused; // set numbers free for new cells
+
+};
+
+// Write a height x width perfect maze to path, row by row, as .maz text
+// or as .mazb when binary is set. Memory use does not depend on height.
+bool generateMazeFile(const std::string& path, int height, int width, uint64_t seed, bool binary, std::string* error = nullptr);
+
+// Generate a height x width perfect maze into grid
+void generateMaze(MazeGrid& grid, int height, int width, uint64_t seed);
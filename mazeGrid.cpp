@@ -0,0 +1,70 @@
+/*
+
+	mazeGrid.cpp
+
+*/
+#include "mazeGrid.h"
+#include <algorithm>
+#include <utility>
+
+MazeGrid::MazeGrid()
+{
+	HEIGHT = 0;
+	WIDTH = 0;
+	hWords = 0;
+	vWords = 0;
+	hBits = vBits = nullptr;
+	entranceRow = entranceCol = 0;
+	exitRow = exitCol = 0;
+}
+
+void MazeGrid::resize(int height, int width)
+{
+	HEIGHT = height;
+	WIDTH = width;
+	hWords = ((size_t)width + 63) / 64;
+	vWords = ((size_t)width + 64) / 64;
+	size_t hCount = ((size_t)height + 1) * hWords, vCount = (size_t)height * vWords;
+	arena.reserve((hCount + vCount) * sizeof(uint64_t));
+	hBits = arena.allocate<uint64_t>(hCount);
+	vBits = arena.allocate<uint64_t>(vCount);
+	std::fill_n(hBits, hCount, 0);
+	std::fill_n(vBits, vCount, 0);
+	entranceRow = 0;
+	entranceCol = 0;
+	exitRow = height - 1;
+	exitCol = width - 1;
+}
+
+void MazeGrid::swap(MazeGrid& other)
+{
+	std::swap(HEIGHT, other.HEIGHT);
+	std::swap(WIDTH, other.WIDTH);
+	std::swap(hWords, other.hWords);
+	std::swap(vWords, other.vWords);
+	arena.swap(other.arena);
+	std::swap(hBits, other.hBits);
+	std::swap(vBits, other.vBits);
+	std::swap(entranceRow, other.entranceRow);
+	std::swap(entranceCol, other.entranceCol);
+	std::swap(exitRow, other.exitRow);
+	std::swap(exitCol, other.exitCol);
+}
+
+void MazeGrid::clear()
+{
+	reset();
+	arena.release();
+}
+
+void MazeGrid::reset()
+{
+	HEIGHT = 0;
+	WIDTH = 0;
+	hWords = 0;
+	vWords = 0;
+	arena.reset();
+	hBits = vBits = nullptr;
+	entranceRow = entranceCol = 0;
+	exitRow = exitCol = 0;
+}
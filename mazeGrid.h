@@ -0,0 +1,164 @@
+/*
+
+	mazeGrid.h
+
+	Wall grid shared by the openFrameworks app and the headless tools.
+	Has no dependency on openFrameworks or Windows headers.
+
+	Walls are kept in two bitplanes so every wall is stored exactly once:
+
+	  horizontal : HEIGHT + 1 rows of WIDTH bits. Bit c of row r is the wall
+	               above cell (r, c); row HEIGHT is the bottom border.
+	  vertical   : HEIGHT rows of WIDTH + 1 bits. Bit c of row r is the wall
+	               left of cell (r, c); bit WIDTH is the right border.
+
+	Each row starts on a 64-bit word so solvers can work on 64 cells at a
+	time with the *WallWord functions.
+
+	Both bitplanes live in one MazeArena block owned by the grid. resize()
+	reuses the block when the new maze fits in it, so loading maze after
+	maze into the same grid allocates only when a maze is larger than any
+	before it. clear() frees the block; reset() empties the grid but keeps
+	it.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "mazeArena.h"
+
+// wall bit flag
+#define WALL_UP 0b1000
+#define WALL_RIGHT 0b0100
+#define WALL_DOWN 0b0010
+#define WALL_LEFT 0b0001
+
+// Move directions. The wall flag of a direction is (WALL_UP >> dir)
+enum MazeDir {
+	DIR_UP = 0,
+	DIR_RIGHT = 1,
+	DIR_DOWN = 2,
+	DIR_LEFT = 3
+};
+
+static const int MAZE_DROW[4] = { -1, 0, 1, 0 };
+static const int MAZE_DCOL[4] = { 0, 1, 0, -1 };
+
+inline int mazeWallFlag(int dir) { return WALL_UP >> dir; }
+inline int mazeOpposite(int dir) { return (dir + 2) & 3; }
+
+class MazeGrid {
+
+public:
+
+	MazeGrid();
+
+	// Set the size and remove every wall
+	void resize(int height, int width);
+	// Release the grid and its block
+	void clear();
+	// Make the grid empty, keeping the block for the next resize
+	void reset();
+	// Exchange contents with other without copying the walls
+	void swap(MazeGrid& other);
+
+	bool empty() const { return HEIGHT == 0 || WIDTH == 0; }
+	int height() const { return HEIGHT; }
+	int width() const { return WIDTH; }
+	size_t cellCount() const { return (size_t)HEIGHT * WIDTH; }
+	size_t index(int row, int col) const { return (size_t)row * WIDTH + col; }
+
+	// Single walls. (row, col) addresses the bitplane, not a cell: hWall
+	// takes row 0..HEIGHT and vWall takes col 0..WIDTH.
+	bool hWall(int row, int col) const { return (hBits[hOffset(row) + (col >> 6)] >> (col & 63)) & 1; }
+	bool vWall(int row, int col) const { return (vBits[vOffset(row) + (col >> 6)] >> (col & 63)) & 1; }
+	void setHWall(int row, int col, bool on) { setBit(hBits[hOffset(row) + (col >> 6)], col & 63, on); }
+	void setVWall(int row, int col, bool on) { setBit(vBits[vOffset(row) + (col >> 6)], col & 63, on); }
+
+	// WALL_* flags of a cell
+	int walls(int row, int col) const {
+		return (hWall(row, col) ? WALL_UP : 0) | (vWall(row, col + 1) ? WALL_RIGHT : 0)
+			| (hWall(row + 1, col) ? WALL_DOWN : 0) | (vWall(row, col) ? WALL_LEFT : 0);
+	}
+	// Set all four walls of a cell. Shared walls change for the neighbours too.
+	void setWalls(int row, int col, int flags) {
+		setHWall(row, col, (flags & WALL_UP) != 0);
+		setVWall(row, col + 1, (flags & WALL_RIGHT) != 0);
+		setHWall(row + 1, col, (flags & WALL_DOWN) != 0);
+		setVWall(row, col, (flags & WALL_LEFT) != 0);
+	}
+
+	// Wall on side dir of a cell
+	bool hasWall(int row, int col, int dir) const {
+		switch (dir) {
+		case DIR_UP: return hWall(row, col);
+		case DIR_RIGHT: return vWall(row, col + 1);
+		case DIR_DOWN: return hWall(row + 1, col);
+		default: return vWall(row, col);
+		}
+	}
+	void setWall(int row, int col, int dir, bool on) {
+		switch (dir) {
+		case DIR_UP: setHWall(row, col, on); break;
+		case DIR_RIGHT: setVWall(row, col + 1, on); break;
+		case DIR_DOWN: setHWall(row + 1, col, on); break;
+		default: setVWall(row, col, on); break;
+		}
+	}
+
+	// True if there is no wall between the cell and its neighbour in dir
+	bool canMove(int row, int col, int dir) const { return !hasWall(row, col, dir); }
+
+	//
+	// Word access: bit b of word w covers column 64 * w + b of a cell row.
+	// Bits past WIDTH in the last word are undefined; mask with lastWordMask().
+	//
+	int rowWords() const { return (int)hWords; }
+	uint64_t lastWordMask() const { return (WIDTH & 63) ? (~0ULL >> (64 - (WIDTH & 63))) : ~0ULL; }
+	uint64_t upWallWord(int row, int w) const { return hBits[hOffset(row) + w]; }
+	uint64_t downWallWord(int row, int w) const { return hBits[hOffset(row + 1) + w]; }
+	uint64_t leftWallWord(int row, int w) const { return vBits[vOffset(row) + w]; }
+	uint64_t rightWallWord(int row, int w) const {
+		const uint64_t* v = &vBits[vOffset(row)];
+		return (v[w] >> 1) | ((size_t)w + 1 < vWords ? v[w + 1] << 63 : 0);
+	}
+
+	// Raw bitplane rows, for loaders and generators that fill whole words
+	uint64_t* hRow(int row) { return &hBits[hOffset(row)]; }
+	uint64_t* vRow(int row) { return &vBits[vOffset(row)]; }
+	const uint64_t* hRow(int row) const { return &hBits[hOffset(row)]; }
+	const uint64_t* vRow(int row) const { return &vBits[vOffset(row)]; }
+	size_t hRowWords() const { return hWords; }
+	size_t vRowWords() const { return vWords; }
+
+	// Entrance and exit cells. By default the top-left and bottom-right cells
+	int entranceRow, entranceCol;
+	int exitRow, exitCol;
+
+	// Bytes of wall storage this maze uses, and bytes the grid holds for it,
+	// which stay at the largest maze loaded until clear()
+	size_t memoryBytes() const { return arena.used(); }
+	size_t reservedBytes() const { return arena.capacity(); }
+
+private:
+
+	MazeGrid(const MazeGrid&);
+	MazeGrid& operator=(const MazeGrid&);
+
+	size_t hOffset(int row) const { return (size_t)row * hWords; }
+	size_t vOffset(int row) const { return (size_t)row * vWords; }
+	static void setBit(uint64_t& word, int bit, bool on) {
+		if (on) word |= 1ULL << bit;
+		else word &= ~(1ULL << bit);
+	}
+
+	int HEIGHT;
+	int WIDTH;
+	size_t hWords; // words per horizontal wall row
+	size_t vWords; // words per vertical wall row
+	MazeArena arena;
+	uint64_t* hBits; // both in arena
+	uint64_t* vBits;
+
+};
@@ -0,0 +1,498 @@
+/*
+
+	mazeHpa.cpp
+
+*/
+#include "mazeHpa.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+// Border runs this long get a crossing at each end instead of one in the middle
+static const int LONG_RUN = 6;
+
+MazeHpa::MazeHpa(int clusterSize)
+{
+	size = clusterSize < 4 ? 4 : clusterSize;
+	H = W = 0;
+	clusterRows = clusterCols = 0;
+	expanded = 0;
+	stamp = 0;
+	searchStamp = 0;
+	localR0 = localC0 = localR1 = localC1 = 0;
+	localCluster = -1;
+}
+
+size_t MazeHpa::edgeCount() const
+{
+	size_t count = 0;
+	for (size_t i = 0; i < edges.size(); i++)
+		count += edges[i].size();
+	return count;
+}
+
+size_t MazeHpa::memoryBytes() const
+{
+	size_t bytes = nodes.capacity() * sizeof(Node);
+	bytes += (g.capacity() + seen.capacity() + parent.capacity()) * sizeof(uint32_t) + heap.capacity() * sizeof(HeapEntry);
+	bytes += nodeAt.size() * (2 * sizeof(uint32_t) + 2 * sizeof(void*));
+	for (size_t i = 0; i < edges.size(); i++)
+		bytes += edges[i].capacity() * sizeof(Edge);
+	for (size_t k = 0; k < members.size(); k++) {
+		bytes += members[k].capacity() * sizeof(uint32_t);
+		bytes += (rightBorder[k].capacity() + downBorder[k].capacity()) * sizeof(Links::value_type);
+	}
+	bytes += (localStamp.capacity() + localDist.capacity() + localQueue.capacity()) * sizeof(uint32_t);
+	return bytes + localDir.capacity() + localWalls.capacity();
+}
+
+void MazeHpa::clusterBounds(int k, int& r0, int& c0, int& r1, int& c1) const
+{
+	r0 = k / clusterCols * size;
+	c0 = k % clusterCols * size;
+	r1 = std::min(r0 + size, H);
+	c1 = std::min(c0 + size, W);
+}
+
+void MazeHpa::build(const MazeGrid& grid)
+{
+	H = grid.height();
+	W = grid.width();
+	clusterRows = (H + size - 1) / size;
+	clusterCols = (W + size - 1) / size;
+	size_t clusters = (size_t)clusterRows * clusterCols;
+
+	nodes.clear();
+	edges.clear();
+	freeIds.clear();
+	nodeAt.clear();
+	members.assign(clusters, std::vector<uint32_t>());
+	rightBorder.assign(clusters, Links());
+	downBorder.assign(clusters, Links());
+
+	localStamp.assign((size_t)size * size, 0);
+	localDist.resize((size_t)size * size);
+	localDir.resize((size_t)size * size);
+	localQueue.resize((size_t)size * size);
+	localWalls.resize((size_t)size * size);
+	localCluster = -1;
+	stamp = 0;
+
+	for (int k = 0; k < (int)clusters; k++) {
+		buildBorder(grid, k, false);
+		buildBorder(grid, k, true);
+	}
+	for (int k = 0; k < (int)clusters; k++)
+		buildIntra(grid, k);
+}
+
+int MazeHpa::update(const MazeGrid& grid, int row, int col, int dir)
+{
+	int nr = row + MAZE_DROW[dir];
+	int nc = col + MAZE_DCOL[dir];
+	int k = clusterOf(grid.index(row, col));
+	localCluster = -1;
+	int touched[4] = { k, -1, -1, -1 };
+	int count = 1;
+	if (nr < 0 || nr >= H || nc < 0 || nc >= W) {
+		buildIntra(grid, k);
+		return 1;
+	}
+
+	int other = clusterOf(grid.index(nr, nc));
+	if (other != k) {
+		// A border wall: redo the crossings of that border
+		rebuildBorder(grid, std::min(k, other), dir == DIR_UP || dir == DIR_DOWN);
+		touched[count++] = other;
+	}
+	else {
+		// A wall along the edge of the cluster can join or split a run of
+		// crossings on that border
+		int r0, c0, r1, c1;
+		clusterBounds(k, r0, c0, r1, c1);
+		bool vertical = dir == DIR_UP || dir == DIR_DOWN;
+		int lo = vertical ? c0 : r0, hi = vertical ? c1 : r1, at = vertical ? col : row;
+		int step = vertical ? 1 : clusterCols;
+		bool hasBefore = vertical ? c0 > 0 : r0 > 0;
+		bool hasAfter = vertical ? c1 < W : r1 < H;
+		if (at == lo && hasBefore) {
+			rebuildBorder(grid, k - step, !vertical);
+			touched[count++] = k - step;
+		}
+		if (at == hi - 1 && hasAfter) {
+			rebuildBorder(grid, k, !vertical);
+			touched[count++] = k + step;
+		}
+	}
+	for (int i = 0; i < count; i++)
+		buildIntra(grid, touched[i]);
+	return count;
+}
+
+void MazeHpa::rebuildBorder(const MazeGrid& grid, int k, bool below)
+{
+	clearBorder(below ? downBorder[k] : rightBorder[k]);
+	buildBorder(grid, k, below);
+}
+
+uint32_t MazeHpa::nodeFor(size_t cell)
+{
+	std::unordered_map<uint32_t, uint32_t>::iterator it = nodeAt.find((uint32_t)cell);
+	if (it != nodeAt.end()) {
+		nodes[it->second].refs++;
+		return it->second;
+	}
+	uint32_t id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else {
+		id = (uint32_t)nodes.size();
+		nodes.push_back(Node());
+		edges.push_back(std::vector<Edge>());
+	}
+	Node& node = nodes[id];
+	node.cell = (uint32_t)cell;
+	node.row = (int)(cell / W);
+	node.col = (int)(cell % W);
+	node.cluster = clusterOf(cell);
+	node.refs = 1;
+	nodeAt[(uint32_t)cell] = id;
+	members[clusterOf(cell)].push_back(id);
+	return id;
+}
+
+void MazeHpa::release(uint32_t id)
+{
+	if (--nodes[id].refs > 0)
+		return;
+	// Edges are symmetric, so the node's own list names every edge into it
+	const std::vector<Edge>& out = edges[id];
+	for (size_t i = 0; i < out.size(); i++) {
+		std::vector<Edge>& back = edges[out[i].to];
+		for (size_t j = 0; j < back.size(); j++) {
+			if (back[j].to == id) {
+				back.erase(back.begin() + j);
+				break;
+			}
+		}
+	}
+	std::vector<uint32_t>& list = members[nodes[id].cluster];
+	list.erase(std::find(list.begin(), list.end(), id));
+	nodeAt.erase(nodes[id].cell);
+	edges[id].clear();
+	freeIds.push_back(id);
+}
+
+void MazeHpa::addCrossing(Links& border, size_t a, size_t b)
+{
+	uint32_t na = nodeFor(a), nb = nodeFor(b);
+	Edge ab = { nb, 1 }, ba = { na, 1 };
+	edges[na].push_back(ab);
+	edges[nb].push_back(ba);
+	border.push_back(std::make_pair(na, nb));
+}
+
+void MazeHpa::clearBorder(Links& border)
+{
+	for (size_t i = 0; i < border.size(); i++) {
+		uint32_t ends[2] = { border[i].first, border[i].second };
+		for (int e = 0; e < 2; e++) {
+			std::vector<Edge>& list = edges[ends[e]];
+			for (size_t j = 0; j < list.size(); j++) {
+				if (list[j].to == ends[1 - e] && list[j].cost == 1) {
+					list.erase(list.begin() + j);
+					break;
+				}
+			}
+		}
+		release(ends[0]);
+		release(ends[1]);
+	}
+	border.clear();
+}
+
+void MazeHpa::buildBorder(const MazeGrid& grid, int k, bool below)
+{
+	int r0, c0, r1, c1;
+	clusterBounds(k, r0, c0, r1, c1);
+	Links& border = below ? downBorder[k] : rightBorder[k];
+	if ((below && r1 >= H) || (!below && c1 >= W))
+		return;
+
+	// Walk the border and cut it into runs of open crossings. A run also
+	// needs the cells along it open to each other on both sides, or two
+	// corridors that happen to meet the border side by side would share a
+	// single crossing.
+	int length = below ? c1 - c0 : r1 - r0;
+	int dir = below ? DIR_DOWN : DIR_RIGHT;
+	int along = below ? DIR_RIGHT : DIR_DOWN;
+	int start = -1;
+	for (int i = 0; i <= length; i++) {
+		int row = below ? r1 - 1 : r0 + i;
+		int col = below ? c0 + i : c1 - 1;
+		bool open = i < length && grid.canMove(row, col, dir);
+		if (open && start >= 0) {
+			int pr = row - MAZE_DROW[along], pc = col - MAZE_DCOL[along];
+			bool joined = grid.canMove(pr, pc, along)
+				&& grid.canMove(pr + MAZE_DROW[dir], pc + MAZE_DCOL[dir], along);
+			if (!joined) {
+				addRun(grid, border, below, r0, c0, r1, c1, start, i);
+				start = -1;
+			}
+		}
+		if (open && start < 0)
+			start = i;
+		if (open || start < 0)
+			continue;
+		addRun(grid, border, below, r0, c0, r1, c1, start, i);
+		start = -1;
+	}
+}
+
+void MazeHpa::addRun(const MazeGrid& grid, Links& border, bool below, int r0, int c0, int r1, int c1, int start, int end)
+{
+	int dir = below ? DIR_DOWN : DIR_RIGHT;
+	int run = end - start;
+	int picks[2] = { start + run / 2, -1 };
+	if (run >= LONG_RUN) {
+		picks[0] = start;
+		picks[1] = end - 1;
+	}
+	for (int p = 0; p < 2 && picks[p] >= 0; p++) {
+		int pr = below ? r1 - 1 : r0 + picks[p];
+		int pc = below ? c0 + picks[p] : c1 - 1;
+		addCrossing(border, grid.index(pr, pc), grid.index(pr + MAZE_DROW[dir], pc + MAZE_DCOL[dir]));
+	}
+}
+
+void MazeHpa::buildIntra(const MazeGrid& grid, int k)
+{
+	std::vector<uint32_t>& list = members[k];
+
+	// Keep only the crossing edges, which lead out of the cluster
+	for (size_t i = 0; i < list.size(); i++) {
+		std::vector<Edge>& out = edges[list[i]];
+		size_t kept = 0;
+		for (size_t j = 0; j < out.size(); j++)
+			if (nodes[out[j].to].cluster != k)
+				out[kept++] = out[j];
+		out.resize(kept);
+	}
+
+	for (size_t i = 0; i < list.size(); i++) {
+		localSearch(grid, nodes[list[i]].cell);
+		for (size_t j = 0; j < list.size(); j++) {
+			uint32_t d = localDistance(nodes[list[j]].cell);
+			if (j != i && d != UINT32_MAX) {
+				Edge e = { list[j], d };
+				edges[list[i]].push_back(e);
+			}
+		}
+	}
+}
+
+void MazeHpa::loadCluster(const MazeGrid& grid, int k)
+{
+	if (k == localCluster)
+		return;
+	localCluster = k;
+	clusterBounds(k, localR0, localC0, localR1, localC1);
+	// Walls of the cluster's cells, closed at the cluster's edges too
+	for (int r = localR0; r < localR1; r++) {
+		uint8_t* out = &localWalls[(size_t)(r - localR0) * size];
+		for (int c = localC0; c < localC1; c++) {
+			int flags = grid.walls(r, c);
+			if (r == localR0) flags |= WALL_UP;
+			if (r == localR1 - 1) flags |= WALL_DOWN;
+			if (c == localC0) flags |= WALL_LEFT;
+			if (c == localC1 - 1) flags |= WALL_RIGHT;
+			out[c - localC0] = (uint8_t)flags;
+		}
+	}
+}
+
+void MazeHpa::localSearch(const MazeGrid& grid, size_t cell)
+{
+	loadCluster(grid, clusterOf(cell));
+	if (++stamp == 0) {
+		std::fill(localStamp.begin(), localStamp.end(), 0);
+		stamp = 1;
+	}
+
+	int row = (int)(cell / W), col = (int)(cell % W);
+	uint32_t at = (uint32_t)((row - localR0) * size + (col - localC0));
+	const int step[4] = { -size, 1, size, -1 };
+	localStamp[at] = stamp;
+	localDist[at] = 0;
+	size_t head = 0, tail = 0;
+	localQueue[tail++] = at;
+	while (head < tail) {
+		uint32_t cur = localQueue[head++];
+		int flags = localWalls[cur];
+		for (int dir = 0; dir < 4; dir++) {
+			if (flags & mazeWallFlag(dir))
+				continue;
+			uint32_t next = cur + step[dir];
+			if (localStamp[next] == stamp)
+				continue;
+			localStamp[next] = stamp;
+			localDist[next] = localDist[cur] + 1;
+			localDir[next] = (uint8_t)dir;
+			localQueue[tail++] = next;
+		}
+	}
+}
+
+uint32_t MazeHpa::localDistance(size_t cell) const
+{
+	int row = (int)(cell / W), col = (int)(cell % W);
+	if (row < localR0 || row >= localR1 || col < localC0 || col >= localC1)
+		return UINT32_MAX;
+	size_t at = (size_t)(row - localR0) * size + (col - localC0);
+	return localStamp[at] == stamp ? localDist[at] : UINT32_MAX;
+}
+
+void MazeHpa::appendLocalPath(const MazeGrid& grid, size_t from, size_t to, MazePath& path)
+{
+	if (from == to)
+		return;
+	if (clusterOf(from) != clusterOf(to)) {
+		// A crossing: the cells are neighbours
+		bool sameRow = to / W == from / W;
+		int dir = sameRow ? (to > from ? DIR_RIGHT : DIR_LEFT) : (to > from ? DIR_DOWN : DIR_UP);
+		path.push(dir);
+		return;
+	}
+	localSearch(grid, from);
+	uint32_t d = localDistance(to);
+	size_t base = path.size();
+	path.resize(base + d);
+	int row = (int)(to / W), col = (int)(to % W);
+	for (uint32_t i = d; i > 0; i--) {
+		int dir = localDir[(size_t)(row - localR0) * size + (col - localC0)];
+		path.set(base + i - 1, dir);
+		row -= MAZE_DROW[dir];
+		col -= MAZE_DCOL[dir];
+	}
+}
+
+uint32_t MazeHpa::search(const MazeGrid& grid, size_t a, size_t b, std::vector<uint32_t>* hops)
+{
+	expanded = 0;
+	if (hops)
+		hops->clear();
+	if (a == b)
+		return 0;
+
+	size_t count = nodes.size();
+	if (g.size() < count) {
+		g.resize(count);
+		seen.resize(count, 0);
+		parent.resize(count);
+	}
+	// seen holds 2 * stamp for open nodes and 2 * stamp + 1 once closed
+	if (++searchStamp >= 0x80000000U) {
+		std::fill(seen.begin(), seen.end(), 0);
+		searchStamp = 1;
+	}
+	uint32_t open = searchStamp * 2, closed = open + 1;
+
+	int goalCluster = clusterOf(b);
+	int br = (int)(b / W), bc = (int)(b % W);
+
+	// Distances from b to the nodes of its cluster, and to a if a shares it
+	localSearch(grid, b);
+	Links goal;
+	for (size_t i = 0; i < members[goalCluster].size(); i++) {
+		uint32_t id = members[goalCluster][i];
+		uint32_t d = localDistance(nodes[id].cell);
+		if (d != UINT32_MAX)
+			goal.push_back(std::make_pair(id, d));
+	}
+	uint32_t best = localDistance(a);
+	uint32_t bestNode = UINT32_MAX; // node before b on the best path, none if direct
+
+	// Min-heap of f << 32 | g, node
+	std::greater<HeapEntry> later;
+	heap.clear();
+	localSearch(grid, a);
+	std::vector<uint32_t>& first = members[clusterOf(a)];
+	for (size_t i = 0; i < first.size(); i++) {
+		uint32_t id = first[i];
+		uint32_t d = localDistance(nodes[id].cell);
+		if (d == UINT32_MAX)
+			continue;
+		seen[id] = open;
+		g[id] = d;
+		parent[id] = UINT32_MAX;
+		uint64_t f = d + (uint32_t)(std::abs(nodes[id].row - br) + std::abs(nodes[id].col - bc));
+		heap.push_back(HeapEntry(f << 32 | d, id));
+		std::push_heap(heap.begin(), heap.end(), later);
+	}
+
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), later);
+		HeapEntry top = heap.back();
+		heap.pop_back();
+		uint32_t u = top.second;
+		if (seen[u] == closed || (uint32_t)top.first != g[u])
+			continue;
+		if ((top.first >> 32) >= best)
+			break;
+		seen[u] = closed;
+		expanded++;
+
+		if (nodes[u].cluster == goalCluster) {
+			for (size_t i = 0; i < goal.size(); i++) {
+				if (goal[i].first == u && g[u] + goal[i].second < best) {
+					best = g[u] + goal[i].second;
+					bestNode = u;
+				}
+			}
+		}
+		const std::vector<Edge>& out = edges[u];
+		for (size_t j = 0; j < out.size(); j++) {
+			uint32_t v = out[j].to;
+			uint32_t cost = g[u] + out[j].cost;
+			if (seen[v] == closed || (seen[v] == open && g[v] <= cost))
+				continue;
+			seen[v] = open;
+			g[v] = cost;
+			parent[v] = u;
+			uint64_t f = cost + (uint32_t)(std::abs(nodes[v].row - br) + std::abs(nodes[v].col - bc));
+			heap.push_back(HeapEntry(f << 32 | cost, v));
+			std::push_heap(heap.begin(), heap.end(), later);
+		}
+	}
+
+	if (hops && best != UINT32_MAX) {
+		for (uint32_t u = bestNode; u != UINT32_MAX; u = parent[u])
+			hops->push_back(u);
+		std::reverse(hops->begin(), hops->end());
+	}
+	return best;
+}
+
+uint32_t MazeHpa::distance(const MazeGrid& grid, size_t a, size_t b)
+{
+	return search(grid, a, b, nullptr);
+}
+
+bool MazeHpa::path(const MazeGrid& grid, size_t a, size_t b, MazePath& path)
+{
+	path.reset((int)(a / W), (int)(a % W));
+	std::vector<uint32_t> hops;
+	if (search(grid, a, b, &hops) == UINT32_MAX)
+		return false;
+
+	// Refine each hop inside the one cluster it stays in
+	size_t at = a;
+	for (size_t i = 0; i < hops.size(); i++) {
+		appendLocalPath(grid, at, nodes[hops[i]].cell, path);
+		at = nodes[hops[i]].cell;
+	}
+	appendLocalPath(grid, at, b, path);
+	return true;
+}
@@ -0,0 +1,133 @@
+/*
+
+	mazeHpa.h
+
+	Hierarchical path-finding (HPA*) for repeated queries on mazes with
+	loops, where MazeTreeOracle does not apply.
+
+	The grid is cut into square clusters. Where a run of open cells,
+	joined to each other on both sides, crosses the border between two
+	clusters, crossings become pairs of abstract nodes joined by one-step
+	edges: one in the middle of a short run, one at each end of a run of
+	six or more. Inside
+	every cluster a breadth-first search confined to the cluster links each
+	pair of its nodes by their distance. The abstract graph is small, so a
+	query links its two cells to the nodes of their clusters, runs A* on
+	the abstract graph and refines only the hops it takes with searches
+	inside single clusters.
+
+	Distances are exact when every border run is one cell wide, which is
+	the common case in a maze. Wider runs can make the result a few steps
+	longer than the shortest path, as in HPA*.
+
+	After a wall changes, update() rebuilds the clusters next to it and the
+	crossings of any border the wall lies on or runs along.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeHpa {
+
+public:
+
+	explicit MazeHpa(int clusterSize = 32);
+
+	// Build the hierarchy for grid
+	void build(const MazeGrid& grid);
+
+	// Call after the wall on side dir of cell (row, col) changed. Returns
+	// the number of clusters rebuilt.
+	int update(const MazeGrid& grid, int row, int col, int dir);
+
+	// Length of the path from cell a to cell b, or UINT32_MAX if there is
+	// none. Cells are row * width + col.
+	uint32_t distance(const MazeGrid& grid, size_t a, size_t b);
+
+	// Fill path with the steps from cell a to cell b. Returns false if
+	// there is none.
+	bool path(const MazeGrid& grid, size_t a, size_t b, MazePath& path);
+
+	int clusterSize() const { return size; }
+	size_t clusterCount() const { return members.size(); }
+	size_t nodeCount() const { return nodes.size() - freeIds.size(); }
+	size_t edgeCount() const;
+
+	// Abstract nodes expanded by the last query
+	size_t expanded;
+
+	size_t memoryBytes() const;
+
+private:
+
+	struct Node {
+		uint32_t cell;
+		int row, col, cluster;
+		int refs; // crossings using the node
+	};
+	struct Edge {
+		uint32_t to;
+		uint32_t cost;
+	};
+	typedef std::vector<std::pair<uint32_t, uint32_t> > Links; // (node, cost) or (node, node)
+
+	int clusterOf(size_t cell) const {
+		return (int)((cell / W) / size * clusterCols + (cell % W) / size);
+	}
+	void clusterBounds(int k, int& r0, int& c0, int& r1, int& c1) const;
+
+	uint32_t nodeFor(size_t cell);
+	void release(uint32_t id);
+	void addCrossing(Links& border, size_t a, size_t b);
+	void clearBorder(Links& border);
+	void buildBorder(const MazeGrid& grid, int k, bool below);
+	void addRun(const MazeGrid& grid, Links& border, bool below, int r0, int c0, int r1, int c1, int start, int end);
+	void rebuildBorder(const MazeGrid& grid, int k, bool below);
+	void buildIntra(const MazeGrid& grid, int k);
+
+	// Copy the walls of cluster k into the local arrays
+	void loadCluster(const MazeGrid& grid, int k);
+	// Breadth-first search from cell inside its cluster. Leaves distances
+	// and entry directions in the local arrays, stamped with stamp.
+	void localSearch(const MazeGrid& grid, size_t cell);
+	uint32_t localDistance(size_t cell) const;
+	void appendLocalPath(const MazeGrid& grid, size_t from, size_t to, MazePath& path);
+
+	// Abstract A* shared by distance and path. Returns the length and, for
+	// path, fills hops with the abstract nodes in order.
+	uint32_t search(const MazeGrid& grid, size_t a, size_t b, std::vector<uint32_t>* hops);
+
+	int size;
+	int H, W;
+	int clusterRows, clusterCols;
+
+	// Abstract graph. Node ids are reused through freeIds.
+	std::vector<Node> nodes;
+	std::vector<std::vector<Edge> > edges;
+	std::vector<uint32_t> freeIds;
+	std::unordered_map<uint32_t, uint32_t> nodeAt; // cell to node
+	std::vector<std::vector<uint32_t> > members; // nodes of each cluster
+	std::vector<Links> rightBorder, downBorder; // crossings of each cluster's right and lower border
+
+	// Cluster-local search state
+	std::vector<uint32_t> localStamp, localDist;
+	std::vector<uint8_t> localDir, localWalls;
+	std::vector<uint32_t> localQueue;
+	uint32_t stamp;
+	int localCluster; // cluster in localWalls, -1 after the grid changes
+	int localR0, localC0, localR1, localC1;
+
+	// Abstract search state
+	typedef std::pair<uint64_t, uint32_t> HeapEntry;
+	std::vector<uint32_t> g, seen, parent;
+	std::vector<HeapEntry> heap;
+	uint32_t searchStamp;
+
+};
@@ -0,0 +1,536 @@
+/*
+
+	mazeImage.cpp
+
+*/
+#include "mazeImage.h"
+#include "mazeBitset.h"
+#include "mazeRaster.h"
+#include "mazeThreadPool.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Bytes of output a band aims for
+const size_t BAND_BYTES = 4 << 20;
+
+// Raster values, indexes into the palette
+enum { OPEN = 0, WALL = 1, PATH = 2 };
+
+bool fail(std::string* error, const char* msg)
+{
+	if (error) *error = msg;
+	return false;
+}
+
+bool hasExtension(const std::string& file, const char* ext)
+{
+	size_t n = strlen(ext);
+	return file.size() > n && file[file.size() - n - 1] == '.'
+		&& file.compare(file.size() - n, n, ext) == 0;
+}
+
+//--------------------------------------------------------------
+// PNG pieces: CRC-32 for chunks, Adler-32 for the zlib stream, and a
+// deflate encoder with the fixed Huffman codes and distance 1 matches only
+
+uint32_t crcTable[256];
+
+void makeCrcTable()
+{
+	for (uint32_t n = 0; n < 256; n++) {
+		uint32_t c = n;
+		for (int k = 0; k < 8; k++)
+			c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		crcTable[n] = c;
+	}
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* p, size_t n)
+{
+	crc = ~crc;
+	for (size_t i = 0; i < n; i++)
+		crc = crcTable[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+const uint32_t ADLER_BASE = 65521;
+
+uint32_t adler32(uint32_t adler, const uint8_t* p, size_t n)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	while (n > 0) {
+		// 5552 bytes is the most that cannot overflow b before the modulo
+		size_t k = std::min(n, (size_t)5552);
+		n -= k;
+		for (; k > 0; k--) {
+			a += *p++;
+			b += a;
+		}
+		a %= ADLER_BASE;
+		b %= ADLER_BASE;
+	}
+	return a | (b << 16);
+}
+
+// Adler-32 of a run of n zero bytes following data with checksum adler
+uint32_t adler32Zeros(uint32_t adler, uint64_t n)
+{
+	uint64_t a = adler & 0xFFFF, b = adler >> 16;
+	b = (b + (n % ADLER_BASE) * a) % ADLER_BASE;
+	return (uint32_t)(a | (b << 16));
+}
+
+// Adler-32 of two pieces joined, from their checksums and the second's length
+uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, uint64_t len2)
+{
+	uint32_t rem = (uint32_t)(len2 % ADLER_BASE);
+	uint32_t sum1 = adler1 & 0xFFFF;
+	uint32_t sum2 = (uint32_t)(((uint64_t)rem * sum1) % ADLER_BASE);
+	sum1 += (adler2 & 0xFFFF) + ADLER_BASE - 1;
+	sum2 += (adler1 >> 16) + (adler2 >> 16) + ADLER_BASE - rem;
+	if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+	if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+	if (sum2 >= 2 * ADLER_BASE) sum2 -= 2 * ADLER_BASE;
+	if (sum2 >= ADLER_BASE) sum2 -= ADLER_BASE;
+	return sum1 | (sum2 << 16);
+}
+
+// Fixed Huffman literal/length codes, bit reversed for the LSB first stream
+uint16_t litCode[288];
+uint8_t litBits[288];
+
+// Length codes 257..285: base lengths and extra bits
+const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+// Length symbol for each match length 3..258
+uint8_t lengthSymbol[259];
+
+void makeDeflateTables()
+{
+	for (int s = 0; s < 288; s++) {
+		uint32_t code;
+		int bits;
+		if (s < 144) { code = 0x30 + s; bits = 8; }
+		else if (s < 256) { code = 0x190 + s - 144; bits = 9; }
+		else if (s < 280) { code = s - 256; bits = 7; }
+		else { code = 0xC0 + s - 280; bits = 8; }
+		uint32_t reversed = 0;
+		for (int i = 0; i < bits; i++)
+			reversed |= ((code >> i) & 1) << (bits - 1 - i);
+		litCode[s] = (uint16_t)reversed;
+		litBits[s] = (uint8_t)bits;
+	}
+	for (int i = 0; i < 29; i++)
+		for (int len = LENGTH_BASE[i]; len < (i + 1 < 29 ? LENGTH_BASE[i + 1] : 259); len++)
+			lengthSymbol[len] = (uint8_t)i;
+	lengthSymbol[258] = 28;
+}
+
+struct Tables {
+	Tables() { makeCrcTable(); makeDeflateTables(); }
+};
+
+// Deflates one band into one fixed Huffman block, ended with an empty
+// stored block so the output is byte aligned and bands can be joined.
+// Runs of the same byte become distance 1 matches.
+class BandDeflater {
+
+public:
+
+	explicit BandDeflater(std::vector<uint8_t>& output) : out(output), acc(0), count(0),
+		prev(-1), run(0), adler(1), length(0) {
+		put(0, 1); // not the last block
+		put(1, 2); // fixed Huffman codes
+	}
+
+	void write(const uint8_t* p, size_t n) {
+		adler = adler32(adler, p, n);
+		length += n;
+		for (size_t i = 0; i < n; i++) {
+			if (p[i] == prev) {
+				run++;
+				continue;
+			}
+			flushRun();
+			literal(p[i]);
+			prev = p[i];
+		}
+	}
+
+	// n zero bytes, as for a row that repeats the one above under the Up filter
+	void writeZeros(uint64_t n) {
+		if (n == 0)
+			return;
+		adler = adler32Zeros(adler, n);
+		length += n;
+		if (prev != 0) {
+			flushRun();
+			literal(0);
+			prev = 0;
+			n--;
+		}
+		run += n;
+	}
+
+	// End the block. Returns the Adler-32 and length of the bytes written.
+	void finish(uint32_t& checksum, uint64_t& bytes) {
+		flushRun();
+		put(litCode[256], litBits[256]);
+		// Empty stored block: header, pad to a byte, LEN 0 and NLEN 0xFFFF
+		put(0, 3);
+		if (count > 0)
+			put(0, 8 - count);
+		put(0x0000, 16);
+		put(0xFFFF, 16);
+		checksum = adler;
+		bytes = length;
+	}
+
+private:
+
+	void put(uint32_t bits, int n) {
+		acc |= (uint64_t)bits << count;
+		count += n;
+		while (count >= 8) {
+			out.push_back((uint8_t)acc);
+			acc >>= 8;
+			count -= 8;
+		}
+	}
+
+	void literal(int byte) { put(litCode[byte], litBits[byte]); }
+
+	void flushRun() {
+		while (run >= 3) {
+			int len = (int)std::min(run, (uint64_t)258);
+			// Keep a tail of 1 or 2 out of a 258 chunk so it can go as a match
+			if (run > 258 && run - 258 < 3)
+				len = (int)run - 3;
+			int s = lengthSymbol[len];
+			put(litCode[257 + s], litBits[257 + s]);
+			if (LENGTH_EXTRA[s])
+				put(len - LENGTH_BASE[s], LENGTH_EXTRA[s]);
+			put(0, 5); // distance code 0: distance 1
+			run -= len;
+		}
+		for (; run > 0; run--)
+			literal(prev);
+	}
+
+	std::vector<uint8_t>& out;
+	uint64_t acc;
+	int count;
+	int prev;
+	uint64_t run;
+	uint32_t adler;
+	uint64_t length;
+
+};
+
+void putBE32(uint8_t* p, uint32_t v)
+{
+	p[0] = (uint8_t)(v >> 24);
+	p[1] = (uint8_t)(v >> 16);
+	p[2] = (uint8_t)(v >> 8);
+	p[3] = (uint8_t)v;
+}
+
+bool writeChunk(FILE* fp, const char* type, const uint8_t* data, size_t n)
+{
+	uint8_t head[8];
+	putBE32(head, (uint32_t)n);
+	memcpy(head + 4, type, 4);
+	uint32_t crc = crc32(crc32(0, head + 4, 4), data, n);
+	uint8_t tail[4];
+	putBE32(tail, crc);
+	return fwrite(head, 1, 8, fp) == 8 && (n == 0 || fwrite(data, 1, n, fp) == n) && fwrite(tail, 1, 4, fp) == 4;
+}
+
+//--------------------------------------------------------------
+// Cells on a path, and the steps between them, shared by all bands
+
+struct PathMask {
+
+	PathMask(const MazeGrid& grid, const MazePath& path) {
+		size_t cells = grid.cellCount();
+		onPath.reset(cells);
+		joinRight.reset(cells);
+		joinDown.reset(cells);
+		int row = path.startRow, col = path.startCol;
+		onPath.set(grid.index(row, col));
+		for (size_t i = 0; i < path.size(); i++) {
+			int dir = path[i];
+			int nr = row + MAZE_DROW[dir], nc = col + MAZE_DCOL[dir];
+			if (dir == DIR_RIGHT || dir == DIR_DOWN)
+				(dir == DIR_RIGHT ? joinRight : joinDown).set(grid.index(row, col));
+			else
+				(dir == DIR_LEFT ? joinRight : joinDown).set(grid.index(nr, nc));
+			row = nr;
+			col = nc;
+			onPath.set(grid.index(row, col));
+		}
+	}
+
+	MazeBitset onPath, joinRight, joinDown;
+
+};
+
+//--------------------------------------------------------------
+// Draws bands of whole cell rows
+
+class BandRenderer {
+
+public:
+
+	BandRenderer(const MazeGrid& grid, const MazeImageStyle& style, const PathMask* mask, int channels)
+		: grid(grid), style(style), mask(mask), channels(channels) {
+		H = grid.height();
+		W = grid.width();
+		mazeImageSize(grid, style, width, height);
+		rowBytes = (size_t)width * channels;
+		for (int c = 0; c < 3; c++) {
+			palette[OPEN][c] = style.open[c];
+			palette[WALL][c] = style.wall[c];
+			palette[PATH][c] = style.path[c];
+		}
+	}
+
+	int width, height;
+	size_t rowBytes;
+
+	// Output pixel rows of cell rows [row0, row1), plus the bottom wall
+	// row when row1 is the last row
+	int bandHeight(int row0, int row1) const {
+		return (row1 - row0) * (style.cellPixels + style.wallPixels) + (row1 == H ? style.wallPixels : 0);
+	}
+
+	// Raw rows, for PPM
+	void raw(int row0, int row1, std::vector<uint8_t>& out) {
+		rasterize(row0, row1);
+		out.clear();
+		out.reserve((size_t)bandHeight(row0, row1) * rowBytes);
+		for (int k = firstRow(row0); k <= lastRow(row1); k++) {
+			expand(k);
+			for (int i = rowRepeat(k); i > 0; i--)
+				out.insert(out.end(), line.begin(), line.end());
+		}
+	}
+
+	// Rows with the PNG Up filter, deflated
+	void deflate(int row0, int row1, std::vector<uint8_t>& out, uint32_t& adler, uint64_t& bytes) {
+		rasterize(row0, row1);
+		out.clear();
+		BandDeflater z(out);
+
+		// The row above the band, which the first row is filtered against
+		if (row0 > 0)
+			expand(firstRow(row0) - 1);
+		else
+			std::fill(line.begin(), line.end(), 0);
+		above = line;
+
+		static const uint8_t up = 2;
+		filtered.resize(rowBytes);
+		for (int k = firstRow(row0); k <= lastRow(row1); k++) {
+			expand(k);
+			for (size_t i = 0; i < rowBytes; i++)
+				filtered[i] = (uint8_t)(line[i] - above[i]);
+			z.write(&up, 1);
+			z.write(filtered.data(), rowBytes);
+			// Repeats of a row filter to zeros
+			for (int i = rowRepeat(k) - 1; i > 0; i--) {
+				z.write(&up, 1);
+				z.writeZeros(rowBytes);
+			}
+			above.swap(line);
+		}
+		z.finish(adler, bytes);
+	}
+
+private:
+
+	// Raster rows (as in mazeRasterize) that a band draws
+	int firstRow(int row0) const { return 2 * row0; }
+	int lastRow(int row1) const { return row1 == H ? 2 * H : 2 * row1 - 1; }
+	int rowRepeat(int k) const { return k & 1 ? style.cellPixels : style.wallPixels; }
+
+	// Raster cell rows [row0 - 1, row1] into raster, with the path on top
+	void rasterize(int row0, int row1) {
+		base = std::max(row0 - 1, 0);
+		size_t stride = 2 * (size_t)W + 1;
+		raster.resize(stride * (2 * (size_t)(row1 - base) + 1));
+		mazeRasterize(grid, base, 0, row1, W, WALL, OPEN, raster.data(), stride);
+		line.resize(rowBytes);
+		if (!mask)
+			return;
+		for (int r = base; r < row1; r++) {
+			uint8_t* cells = &raster[(2 * (size_t)(r - base) + 1) * stride];
+			for (int c = 0; c < W; c++) {
+				size_t cell = grid.index(r, c);
+				if (!mask->onPath.test(cell))
+					continue;
+				cells[2 * c + 1] = PATH;
+				if (mask->joinRight.test(cell))
+					cells[2 * c + 2] = PATH;
+				if (mask->joinDown.test(cell))
+					cells[stride + 2 * c + 1] = PATH;
+			}
+		}
+	}
+
+	// Widen raster row k into line
+	void expand(int k) {
+		size_t stride = 2 * (size_t)W + 1;
+		const uint8_t* src = &raster[(size_t)(k - 2 * base) * stride];
+		uint8_t* dst = line.data();
+		for (size_t x = 0; x < stride; x++) {
+			int n = x & 1 ? style.cellPixels : style.wallPixels;
+			const uint8_t* rgb = palette[src[x]];
+			if (channels == 1) {
+				memset(dst, rgb[0], n);
+				dst += n;
+			}
+			else {
+				for (int i = 0; i < n; i++, dst += 3) {
+					dst[0] = rgb[0];
+					dst[1] = rgb[1];
+					dst[2] = rgb[2];
+				}
+			}
+		}
+	}
+
+	const MazeGrid& grid;
+	const MazeImageStyle& style;
+	const PathMask* mask;
+	int channels;
+	int H, W;
+	uint8_t palette[3][3];
+
+	// Per band
+	int base; // first cell row in raster
+	std::vector<uint8_t> raster;
+	std::vector<uint8_t> line, above, filtered;
+
+};
+
+bool isGrey(const uint8_t* rgb) { return rgb[0] == rgb[1] && rgb[1] == rgb[2]; }
+
+}
+
+MazeImageStyle::MazeImageStyle() : cellPixels(4), wallPixels(1)
+{
+	for (int c = 0; c < 3; c++) {
+		wall[c] = 0;
+		open[c] = 255;
+	}
+	path[0] = 230;
+	path[1] = 40;
+	path[2] = 40;
+}
+
+bool mazeImageSize(const MazeGrid& grid, const MazeImageStyle& style, int& width, int& height)
+{
+	uint64_t w = (uint64_t)grid.width() * style.cellPixels + (uint64_t)(grid.width() + 1) * style.wallPixels;
+	uint64_t h = (uint64_t)grid.height() * style.cellPixels + (uint64_t)(grid.height() + 1) * style.wallPixels;
+	width = w <= INT_MAX ? (int)w : 0;
+	height = h <= INT_MAX ? (int)h : 0;
+	return w <= INT_MAX && h <= INT_MAX;
+}
+
+bool mazeWriteImage(const MazeGrid& grid, const std::string& file, const MazeImageStyle& style,
+	const MazePath* path, int threads, std::string* error)
+{
+	static const Tables tables;
+	int width, height;
+	if (grid.empty())
+		return fail(error, "empty maze");
+	if (style.cellPixels < 1 || style.wallPixels < 1)
+		return fail(error, "cell and wall sizes must be at least one pixel");
+	if (!mazeImageSize(grid, style, width, height))
+		return fail(error, "image is too large");
+
+	bool png = !hasExtension(file, "ppm") && !hasExtension(file, "pgm");
+	int channels = path || !isGrey(style.wall) || !isGrey(style.open) ? 3 : 1;
+
+	std::unique_ptr<PathMask> mask(path ? new PathMask(grid, *path) : nullptr);
+	MazeThreadPool pool(threads);
+	int n = pool.size();
+	std::vector<std::unique_ptr<BandRenderer> > renderers;
+	for (int i = 0; i < n; i++)
+		renderers.push_back(std::unique_ptr<BandRenderer>(new BandRenderer(grid, style, mask.get(), channels)));
+	BandRenderer& first = *renderers[0];
+
+	// Whole cell rows per band, near BAND_BYTES of output
+	int rowsPerCell = style.cellPixels + style.wallPixels;
+	size_t cellRowBytes = (first.rowBytes + 1) * rowsPerCell;
+	int bandRows = (int)std::max((size_t)1, std::min(BAND_BYTES / cellRowBytes, (size_t)grid.height()));
+	int bands = (grid.height() + bandRows - 1) / bandRows;
+
+	FILE* fp = fopen(file.c_str(), "wb");
+	bool ok = fp != nullptr;
+	if (ok && png) {
+		static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		uint8_t ihdr[13];
+		putBE32(ihdr, (uint32_t)width);
+		putBE32(ihdr + 4, (uint32_t)height);
+		ihdr[8] = 8; // bits per sample
+		ihdr[9] = channels == 1 ? 0 : 2; // grey or RGB
+		ihdr[10] = ihdr[11] = ihdr[12] = 0;
+		static const uint8_t zlibHeader[2] = { 0x78, 0x01 };
+		ok = fwrite(signature, 1, 8, fp) == 8 && writeChunk(fp, "IHDR", ihdr, 13)
+			&& writeChunk(fp, "IDAT", zlibHeader, 2);
+	}
+	else if (ok) {
+		char header[64];
+		int len = sprintf(header, "P%d\n%d %d\n255\n", channels == 1 ? 5 : 6, width, height);
+		ok = fwrite(header, 1, len, fp) == (size_t)len;
+	}
+
+	// A batch of bands at a time, one per thread, then write them in order
+	std::vector<std::vector<uint8_t> > out(n);
+	std::vector<uint32_t> adlers(n);
+	std::vector<uint64_t> lengths(n);
+	uint32_t adler = 1;
+	for (int b0 = 0; ok && b0 < bands; b0 += n) {
+		pool.run([&](int i) {
+			int b = b0 + i;
+			if (b >= bands)
+				return;
+			int row0 = b * bandRows, row1 = std::min(row0 + bandRows, grid.height());
+			if (png)
+				renderers[i]->deflate(row0, row1, out[i], adlers[i], lengths[i]);
+			else
+				renderers[i]->raw(row0, row1, out[i]);
+		});
+		for (int i = 0; ok && i < n && b0 + i < bands; i++) {
+			if (png) {
+				ok = writeChunk(fp, "IDAT", out[i].data(), out[i].size());
+				adler = adler32Combine(adler, adlers[i], lengths[i]);
+			}
+			else {
+				ok = fwrite(out[i].data(), 1, out[i].size(), fp) == out[i].size();
+			}
+		}
+	}
+
+	if (ok && png) {
+		// Empty last block, the checksum, and the end
+		uint8_t tail[6] = { 0x03, 0x00 };
+		putBE32(tail + 2, adler);
+		ok = writeChunk(fp, "IDAT", tail, 6) && writeChunk(fp, "IEND", nullptr, 0);
+	}
+	if (!fp)
+		return fail(error, "cannot create file");
+	if (fclose(fp) != 0)
+		ok = false;
+	return ok || fail(error, "write failed");
+}
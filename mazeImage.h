@@ -0,0 +1,48 @@
+/*
+
+	mazeImage.h
+
+	Renders a maze, and optionally a path through it, straight to a PNG or
+	PPM file without a GPU, for thumbnails and prints of large mazes.
+
+	The image is laid out like mazeRasterize, with every cell and every
+	wall line widened: cell columns and rows are cellPixels wide, wall
+	columns and rows wallPixels.
+
+	The image is cut into horizontal bands of whole cell rows. Worker
+	threads rasterize and encode a batch of bands at a time, and the bands
+	are written out in order before the next batch starts, so only one
+	batch of bands is ever in memory. PNG output is deflated with run
+	length matches on top of the PNG Up filter, which shrinks rows that
+	repeat the row above them to a few bytes.
+
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+struct MazeImageStyle {
+
+	MazeImageStyle();
+
+	int cellPixels; // width and height of a cell
+	int wallPixels; // thickness of a wall
+	uint8_t wall[3]; // RGB colours
+	uint8_t open[3];
+	uint8_t path[3];
+
+};
+
+// Size in pixels of the image of grid drawn with style. Returns false if
+// it does not fit in an int.
+bool mazeImageSize(const MazeGrid& grid, const MazeImageStyle& style, int& width, int& height);
+
+// Write grid to file as PNG, or as binary PPM (PGM when grey) if the name
+// ends in .ppm or .pgm. With path the path is drawn over the cells it
+// passes. The image is grey unless a path is given or a colour is not
+// grey. threads == 0 uses all hardware threads.
+bool mazeWriteImage(const MazeGrid& grid, const std::string& file, const MazeImageStyle& style,
+	const MazePath* path = nullptr, int threads = 0, std::string* error = nullptr);
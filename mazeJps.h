@@ -0,0 +1,208 @@
+/*
+
+	mazeJps.h
+
+	Jump point search adapted to the maze's wall grid.
+
+	On an open grid jump point search skips the many equal-length paths
+	through empty space. In a maze those are rare; the waste is walking
+	corridors one cell at a time, queueing every cell. Here a jump follows
+	a corridor through its turns without touching the open list and stops
+	only where the search has a choice: a junction, the entrance or the
+	exit. Corridors ending in a dead end are dropped without being queued.
+
+	Only jump points get a g score and an entry direction. The open list is
+	a binary heap on f = g + Manhattan distance with stale entries skipped
+	when popped. The path is rebuilt by walking each corridor backwards
+	from its jump point. In open rooms every cell is a junction and this
+	degrades to plain A*.
+
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include "mazeBitset.h"
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeJps {
+
+public:
+
+	MazeJps() : expanded(0), scanned(0) {}
+
+	// Find a shortest path from the entrance to the exit. Returns false if
+	// there is none, in which case path is left empty.
+	template <class Grid>
+	bool solve(const Grid& grid, MazePath& path);
+
+	// Jump points closed and corridor cells stepped over by the last solve
+	size_t expanded;
+	size_t scanned;
+
+	// Watched by solve, which stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const {
+		return g.capacity() * sizeof(uint32_t) + closed.memoryBytes()
+			+ entry.memoryBytes() + open.capacity() * sizeof(Entry);
+	}
+
+private:
+
+	struct Entry {
+		uint64_t key; // f in the high half, ~g in the low half
+		uint64_t cell;
+		bool operator>(const Entry& o) const { return key > o.key; }
+	};
+
+	// Open directions out of a cell other than back, as a bit mask
+	template <class Grid>
+	static int exits(const Grid& grid, int row, int col, int back);
+
+	std::vector<uint32_t> g;
+	MazeBitset closed;
+	MazeDirArray entry; // direction of the last step into each jump point
+	std::vector<Entry> open;
+
+};
+
+template <class Grid>
+int MazeJps::exits(const Grid& grid, int row, int col, int back)
+{
+	int mask = 0;
+	for (int dir = 0; dir < 4; dir++) {
+		if (dir == back || !grid.canMove(row, col, dir))
+			continue;
+		int nr = row + MAZE_DROW[dir];
+		int nc = col + MAZE_DCOL[dir];
+		if (nr < 0 || nr >= grid.height() || nc < 0 || nc >= grid.width())
+			continue;
+		mask |= 1 << dir;
+	}
+	return mask;
+}
+
+template <class Grid>
+bool MazeJps::solve(const Grid& grid, MazePath& path)
+{
+	expanded = 0;
+	scanned = 0;
+	path.reset(grid.entranceRow, grid.entranceCol);
+	if (grid.empty())
+		return false;
+
+	int W = grid.width();
+	int er = grid.exitRow, ec = grid.exitCol;
+	size_t cells = grid.cellCount();
+	g.assign(cells, UINT32_MAX);
+	closed.reset(cells);
+	entry.reset(cells);
+	open.clear();
+
+	size_t start = grid.index(grid.entranceRow, grid.entranceCol);
+	size_t goal = grid.index(er, ec);
+	std::greater<Entry> later;
+	g[start] = 0;
+	open.push_back({ (uint64_t)(abs(grid.entranceRow - er) + abs(grid.entranceCol - ec)) << 32 | UINT32_MAX, start });
+
+	bool found = false;
+	while (!open.empty()) {
+		if (cancel.poll())
+			return false;
+		std::pop_heap(open.begin(), open.end(), later);
+		size_t cur = open.back().cell;
+		open.pop_back();
+		if (closed.testAndSet(cur))
+			continue;
+		expanded++;
+		if (cur == goal) {
+			found = true;
+			break;
+		}
+
+		int row = (int)(cur / W);
+		int col = (int)(cur % W);
+		int first = exits(grid, row, col, -1);
+		for (int dir = 0; dir < 4; dir++) {
+			if (!(first & (1 << dir)))
+				continue;
+
+			// Follow the corridor until the search has a choice to make
+			int r = row + MAZE_DROW[dir];
+			int c = col + MAZE_DCOL[dir];
+			int d = dir;
+			uint32_t cost = 1;
+			bool dead = false;
+			for (;;) {
+				size_t at = grid.index(r, c);
+				if (at == goal || at == start)
+					break;
+				int ways = exits(grid, r, c, mazeOpposite(d));
+				if (ways == 0)
+					dead = true;
+				if (ways == 0 || (ways & (ways - 1)))
+					break;
+				d = ways == 1 ? 0 : ways == 2 ? 1 : ways == 4 ? 2 : 3;
+				r += MAZE_DROW[d];
+				c += MAZE_DCOL[d];
+				cost++;
+				scanned++;
+			}
+			if (dead)
+				continue;
+
+			size_t next = grid.index(r, c);
+			uint32_t ng = g[cur] + cost;
+			if (closed.test(next) || ng >= g[next])
+				continue;
+			g[next] = ng;
+			entry.set(next, d);
+			uint64_t f = ng + (uint64_t)(abs(r - er) + abs(c - ec));
+			open.push_back({ f << 32 | (uint32_t)~ng, next });
+			std::push_heap(open.begin(), open.end(), later);
+		}
+	}
+	if (!found)
+		return false;
+
+	// Step back from cell (row, col), entered by dir, to the cell before it.
+	// Inside a corridor the entry direction is whichever way is not ahead.
+	auto back = [&](int& row, int& col, int& dir) {
+		row -= MAZE_DROW[dir];
+		col -= MAZE_DCOL[dir];
+		size_t at = grid.index(row, col);
+		if (at == start)
+			return;
+		int ways = exits(grid, row, col, -1);
+		if (mazePopcount((uint64_t)ways) == 2) {
+			int behind = ways & ~(1 << dir);
+			dir = mazeOpposite(behind == 1 ? 0 : behind == 2 ? 1 : behind == 4 ? 2 : 3);
+		}
+		else {
+			dir = entry.get(at);
+		}
+	};
+
+	size_t length = 0;
+	int row = er, col = ec, dir = entry.get(goal);
+	while (grid.index(row, col) != start) {
+		back(row, col, dir);
+		length++;
+	}
+	path.resize(length);
+	row = er;
+	col = ec;
+	dir = entry.get(goal);
+	for (size_t i = length; i > 0; i--) {
+		path.set(i - 1, dir);
+		back(row, col, dir);
+	}
+	return true;
+}
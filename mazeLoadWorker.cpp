@@ -0,0 +1,64 @@
+/*
+
+	mazeLoadWorker.cpp
+
+*/
+#include "mazeLoadWorker.h"
+
+MazeLoadWorker::MazeLoadWorker() : state(IDLE), ok(false)
+{
+}
+
+MazeLoadWorker::~MazeLoadWorker()
+{
+	wait();
+}
+
+void MazeLoadWorker::start(const std::string& path)
+{
+	wait();
+	progress.bytesRead.store(0, std::memory_order_relaxed);
+	progress.bytesTotal.store(0, std::memory_order_relaxed);
+	progress.cancel.store(false, std::memory_order_relaxed);
+	file = path;
+	failure.clear();
+	ok = false;
+	state.store(RUNNING, std::memory_order_release);
+	thread = std::thread(&MazeLoadWorker::run, this);
+}
+
+void MazeLoadWorker::wait()
+{
+	if (!thread.joinable())
+		return;
+	cancel();
+	thread.join();
+	state.store(IDLE, std::memory_order_release);
+}
+
+bool MazeLoadWorker::take(MazeGrid& grid, std::string* error)
+{
+	if (!finished())
+		return false;
+	if (thread.joinable())
+		thread.join();
+	state.store(IDLE, std::memory_order_release);
+	if (!ok) {
+		if (error) *error = failure;
+		return false;
+	}
+	grid.swap(loaded);
+	return true;
+}
+
+void MazeLoadWorker::release()
+{
+	wait();
+	loaded.clear();
+}
+
+void MazeLoadWorker::run()
+{
+	ok = loadMazeFile(file, loaded, &failure, &progress);
+	state.store(DONE, std::memory_order_release);
+}
@@ -0,0 +1,81 @@
+/*
+
+	mazeLoadWorker.h
+
+	Loads a maze file on a background thread, so the app keeps drawing the
+	current maze while a large file parses.
+
+	The file is parsed into a grid owned by the worker. Progress is the
+	number of bytes parsed, published through MazeLoadProgress. When the
+	load is done take() swaps the new grid with the caller's, so the caller
+	decides when the maze changes and nothing is copied. The old grid stays
+	in the worker, where nothing reads it, and its buffers are reused by
+	the next load.
+
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "mazeGrid.h"
+#include "mazeLoader.h"
+
+class MazeLoadWorker {
+
+public:
+
+	MazeLoadWorker();
+	~MazeLoadWorker();
+
+	// Start loading path, cancelling and waiting for any load still running
+	void start(const std::string& path);
+
+	// Ask the running load to stop. Returns at once; finished() turns true
+	// when it has stopped, and take() then fails.
+	void cancel() { progress.cancel.store(true, std::memory_order_relaxed); }
+
+	// Cancel and block until the thread has stopped, dropping any result
+	void wait();
+
+	// True from start() until take() has been called on a finished load
+	bool busy() const { return state.load(std::memory_order_acquire) != IDLE; }
+	// True once the load is over and its result can be taken
+	bool finished() const { return state.load(std::memory_order_acquire) == DONE; }
+
+	// Progress of the current or last load. total is 0 until the file is open.
+	uint64_t bytesRead() const { return progress.bytesRead.load(std::memory_order_relaxed); }
+	uint64_t bytesTotal() const { return progress.bytesTotal.load(std::memory_order_relaxed); }
+
+	// File of the current or last load
+	const std::string& path() const { return file; }
+
+	// After finished(): on success swap the loaded grid with grid and return
+	// true. Otherwise leave grid alone and write the reason to error. The
+	// worker is idle afterwards.
+	bool take(MazeGrid& grid, std::string* error = nullptr);
+
+	// Cancel any load and free the grid kept from the last one
+	void release();
+
+private:
+
+	MazeLoadWorker(const MazeLoadWorker&);
+	MazeLoadWorker& operator=(const MazeLoadWorker&);
+
+	enum State { IDLE, RUNNING, DONE };
+
+	void run();
+
+	std::thread thread;
+	std::atomic<int> state;
+	MazeLoadProgress progress;
+
+	// Written by the thread before state turns DONE, read after
+	std::string file;
+	MazeGrid loaded;
+	std::string failure;
+	bool ok;
+
+};
@@ -0,0 +1,231 @@
+/*
+
+	mazeLoader.cpp
+
+	The file is memory mapped and decoded in one pass straight into the
+	wall bitplanes of the grid. Each text row is looked at once; no copy of
+	the text is kept.
+
+*/
+#include "mazeLoader.h"
+#include "mazeBinary.h"
+#include "mazeMappedFile.h"
+#include "mazeMetrics.h"
+#include "mazeTiledGrid.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Walks the lines of the mapped text without copying them.
+// Blank lines are skipped and a trailing '\r' is dropped.
+struct MazeTextCursor {
+	const char* p;
+	const char* end;
+
+	MazeTextCursor(const char* data, size_t size) : p(data), end(data + size) {}
+
+	bool next(const char*& line, size_t& len) {
+		while (p < end) {
+			const char* nl = (const char*)memchr(p, '\n', end - p);
+			const char* lineEnd = nl ? nl : end;
+			line = p;
+			len = lineEnd - p;
+			p = nl ? nl + 1 : end;
+			if (len && line[len - 1] == '\r') len--;
+			if (len) return true;
+		}
+		return false;
+	}
+};
+
+static bool fail(MazeGrid& grid, std::string* error, const char* msg)
+{
+	grid.reset();
+	if (error) *error = msg;
+	return false;
+}
+
+// Number of text lines if every line has the same length as the first one,
+// or -1 when the file is not laid out uniformly.
+static long long uniformLineCount(const char* data, size_t size)
+{
+	const char* nl = (const char*)memchr(data, '\n', size);
+	if (!nl)
+		return 1;
+	size_t stride = nl - data + 1;
+	if (size % stride == 0)
+		return size / stride;
+	if (size % stride == stride - 1 - (nl > data && nl[-1] == '\r'))
+		return size / stride + 1;
+	return -1;
+}
+
+static long long countLines(const char* data, size_t size)
+{
+	MazeTextCursor cur(data, size);
+	const char* line;
+	size_t len;
+	long long n = 0;
+	while (cur.next(line, len)) n++;
+	return n;
+}
+
+// Pack the glyphs at line[start], line[start + 2], ... into bits
+static void packRow(const char* line, int count, int start, char glyph, uint64_t* out)
+{
+	const char* p = line + start;
+	for (int w = 0; count > 0; w++, count -= 64) {
+		int n = count < 64 ? count : 64;
+		uint64_t bits = 0;
+		for (int b = 0; b < n; b++, p += 2)
+			bits |= (uint64_t)(*p == glyph) << b;
+		out[w] = bits;
+	}
+}
+
+// Decode height cell rows. Returns false if the text runs out or a line is
+// too short, or with exact set, if text is left over after the last row.
+// Every '+-+' line fills one horizontal wall row and every '| |' line one
+// vertical wall row of the grid. Also returns false if progress asks to stop.
+static bool decode(const char* data, size_t size, int height, int width, bool exact, MazeGrid& grid,
+	MazeLoadProgress* progress)
+{
+	MazeTextCursor cur(data, size);
+	const char* line;
+	size_t len;
+	size_t need = (size_t)width * 2 + 1;
+
+	grid.resize(height, width);
+	if (!cur.next(line, len) || len < need)
+		return false;
+	packRow(line, width, 1, '-', grid.hRow(0));
+	for (int i = 0; i < height; i++) {
+		if (!cur.next(line, len) || len < need)
+			return false;
+		packRow(line, width + 1, 0, '|', grid.vRow(i));
+		if (!cur.next(line, len) || len < need)
+			return false;
+		packRow(line, width, 1, '-', grid.hRow(i + 1));
+		if (progress && !progress->update(line + len - data))
+			return false;
+	}
+	return !exact || !cur.next(line, len);
+}
+
+static bool decodeText(const char* data, size_t size, MazeGrid& grid, std::string* error,
+	MazeLoadProgress* progress = nullptr)
+{
+	MazeTextCursor cur(data, size);
+	const char* first;
+	size_t firstLen;
+	if (!cur.next(first, firstLen) || firstLen < 3)
+		return fail(grid, error, "file is too small to hold a maze");
+	int width = (int)(firstLen - 1) / 2;
+
+	// Take the height from the file size when all lines are equally long,
+	// so the text is only walked once. Otherwise count the lines first.
+	long long lines = uniformLineCount(data, size);
+	if (progress)
+		progress->bytesTotal.store(size, std::memory_order_relaxed);
+	if (lines >= 3 && decode(data, size, (int)((lines - 1) / 2), width, true, grid, progress)) {
+		if (progress)
+			progress->update(size);
+		return true;
+	}
+	if (progress && progress->cancel.load(std::memory_order_relaxed))
+		return fail(grid, error, "load cancelled");
+
+	lines = countLines(data, size);
+	if (lines < 3)
+		return fail(grid, error, "file is too small to hold a maze");
+	if (!decode(data, size, (int)((lines - 1) / 2), width, false, grid, progress)) {
+		if (progress && progress->cancel.load(std::memory_order_relaxed))
+			return fail(grid, error, "load cancelled");
+		return fail(grid, error, "short line in maze text");
+	}
+	if (progress)
+		progress->update(size);
+	return true;
+}
+
+bool loadMaz(const std::string& path, MazeGrid& grid, std::string* error)
+{
+	MazeMappedFile file;
+	if (!file.open(path))
+		return fail(grid, error, "cannot open file");
+	return decodeText(file.data(), file.size(), grid, error);
+}
+
+bool loadMazeFile(const std::string& path, MazeGrid& grid, std::string* error, MazeLoadProgress* progress)
+{
+	uint64_t t0 = mazeMetricNowUs();
+	MazeMappedFile file;
+	if (!file.open(path))
+		return fail(grid, error, "cannot open file");
+	uint64_t size = file.size();
+	bool ok;
+	if (isMazeBin(file.data(), file.size())) {
+		file.close();
+		ok = loadMazBin(path, grid, error, progress);
+	}
+	else if (isMazeTiled(file.data(), file.size())) {
+		file.close();
+		ok = loadMazTiled(path, grid, error, progress);
+	}
+	else
+		ok = decodeText(file.data(), file.size(), grid, error, progress);
+	if (ok) {
+		mazeMetricLoadUs.record(mazeMetricNowUs() - t0);
+		mazeMetricLoadBytes.record(size);
+		mazeMetricGridBytes.record(grid.memoryBytes());
+		mazeMetricGridReservedBytes.record(grid.reservedBytes());
+	}
+	return ok;
+}
+
+//--------------------------------------------------------------
+bool saveMaz(const MazeGrid& grid, const std::string& path, std::string* error)
+{
+	// The border rows below need at least one cell
+	if (grid.empty()) {
+		if (error) *error = "empty maze";
+		return false;
+	}
+	FILE* fp = fopen(path.c_str(), "wb");
+	if (!fp) {
+		if (error) *error = "cannot create file";
+		return false;
+	}
+	std::vector<char> buffer(1 << 20);
+	setvbuf(fp, buffer.data(), _IOFBF, buffer.size());
+
+	int H = grid.height();
+	int W = grid.width();
+	std::string line(W * 2 + 2, ' ');
+	line[W * 2 + 1] = '\n';
+	bool ok = true;
+
+	// Horizontal wall row above cell row i, or below the last row for i == H
+	for (int i = 0; ok && i <= H; i++) {
+		for (int j = 0; j < W; j++) {
+			line[j * 2] = '+';
+			if (i < H) line[j * 2 + 1] = (grid.walls(i, j) & WALL_UP) ? '-' : ' ';
+			else line[j * 2 + 1] = (grid.walls(H - 1, j) & WALL_DOWN) ? '-' : ' ';
+		}
+		line[W * 2] = '+';
+		ok = fwrite(line.data(), 1, line.size(), fp) == line.size();
+		if (i == H || !ok)
+			break;
+
+		for (int j = 0; j < W; j++) {
+			line[j * 2] = (grid.walls(i, j) & WALL_LEFT) ? '|' : ' ';
+			line[j * 2 + 1] = ' ';
+		}
+		line[W * 2] = (grid.walls(i, W - 1) & WALL_RIGHT) ? '|' : ' ';
+		ok = fwrite(line.data(), 1, line.size(), fp) == line.size();
+	}
+
+	if (fclose(fp) != 0) ok = false;
+	if (!ok && error) *error = "write failed";
+	return ok;
+}
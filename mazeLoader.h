@@ -0,0 +1,51 @@
+/*
+
+	mazeLoader.h
+
+	Reader for the .maz text format
+
+	+-+-+
+	| | |
+	+-+-+
+
+	Every cell (i, j) sits at text position (2i+1, 2j+1). A '-' above or
+	below it and a '|' left or right of it is a wall.
+
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "mazeGrid.h"
+
+// Progress of a load running on another thread, and a way to stop it.
+// The loader stores how far it got as it goes; any thread may read it.
+struct MazeLoadProgress {
+
+	MazeLoadProgress() : bytesRead(0), bytesTotal(0), cancel(false) {}
+
+	// Called by the loaders. Returns false once the load should stop.
+	bool update(uint64_t read) {
+		bytesRead.store(read, std::memory_order_relaxed);
+		return !cancel.load(std::memory_order_relaxed);
+	}
+
+	std::atomic<uint64_t> bytesRead; // bytes of the file parsed so far
+	std::atomic<uint64_t> bytesTotal; // file size, once known
+	std::atomic<bool> cancel; // set to make the loader give up
+
+};
+
+// Load a .maz file into grid. On failure grid is left empty and the
+// reason is written to error when it is given.
+bool loadMaz(const std::string& path, MazeGrid& grid, std::string* error = nullptr);
+
+// Write grid in the .maz text format. Fails if grid is empty.
+bool saveMaz(const MazeGrid& grid, const std::string& path, std::string* error = nullptr);
+
+// Load a .maz, .mazb or .mazt file, chosen by the file contents. With
+// progress given the load reports as it goes, and stops with an error if
+// progress->cancel is set.
+bool loadMazeFile(const std::string& path, MazeGrid& grid, std::string* error = nullptr,
+	MazeLoadProgress* progress = nullptr);
@@ -0,0 +1,246 @@
+/*
+
+	mazeLpa.h
+
+	Lifelong Planning A* (LPA*) from the entrance to the exit, for mazes
+	whose walls are edited between searches.
+
+	Every cell keeps g, its distance as last settled, and rhs, the distance
+	one step from its neighbours' g. A cell where the two differ is
+	inconsistent and waits in the open list under the key
+	[min(g, rhs) + h, min(g, rhs)], with h the Manhattan distance to the
+	exit. The search settles cells in key order until the exit is
+	consistent and no open key is lower than its own, like A*.
+
+	When a wall changes only the two cells on either side of it get a new
+	rhs. Repairing the search then touches just the cells whose distance
+	the wall changed and that can still matter to the exit, instead of
+	starting over. The entrance and exit are fixed; if they move, or the
+	maze changes size, the next update searches from scratch.
+
+	The open list is a binary heap with lazy deletion: an entry whose key
+	no longer matches its cell, or whose cell became consistent, is
+	dropped when it reaches the top.
+
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeLpa {
+
+public:
+
+	MazeLpa() : expanded(0), touched(0), H(0), W(0), start(0), goal(0), goalRow(0), goalCol(0) {}
+
+	// Search from scratch. Returns false if there is no path, in which case
+	// path is left empty.
+	template <class Grid>
+	bool solve(const Grid& grid, MazePath& path);
+
+	// Call after the wall on side dir of cell (row, col) changed. Repairs
+	// the last search and fills path with the new shortest path.
+	template <class Grid>
+	bool wallChanged(const Grid& grid, int row, int col, int dir, MazePath& path);
+
+	// True if there is a finished search of a maze this size with these
+	// ends, so wallChanged repairs it rather than starting from scratch
+	template <class Grid>
+	bool ready(const Grid& grid) const { return matches(grid); }
+
+	// Forget the last search, so the next update starts from scratch
+	void clear() {
+		std::vector<uint32_t>().swap(g);
+		std::vector<uint32_t>().swap(rhs);
+		std::vector<Entry>().swap(heap);
+		H = W = 0;
+	}
+
+	// Cells expanded, and cells whose rhs was recomputed, by the last solve
+	// or update
+	size_t expanded;
+	size_t touched;
+
+	// Watched by solve and wallChanged. A stopped search is forgotten, as
+	// by clear().
+	MazeCancel cancel;
+
+	size_t memoryBytes() const {
+		return (g.capacity() + rhs.capacity()) * sizeof(uint32_t) + heap.capacity() * sizeof(Entry);
+	}
+
+private:
+
+	typedef std::pair<uint64_t, uint32_t> Entry; // (key, cell)
+	enum : uint32_t { INF = UINT32_MAX };
+
+	template <class Grid>
+	bool matches(const Grid& grid) const {
+		return !g.empty() && grid.height() == H && grid.width() == W
+			&& grid.index(grid.entranceRow, grid.entranceCol) == start
+			&& grid.index(grid.exitRow, grid.exitCol) == goal;
+	}
+
+	// Lexicographic [min(g, rhs) + h, min(g, rhs)] packed in one word
+	uint64_t key(size_t cell) const {
+		uint64_t m = std::min(g[cell], rhs[cell]);
+		if (m == INF)
+			return UINT64_MAX;
+		int row = (int)(cell / W), col = (int)(cell % W);
+		uint64_t k = m + (uint64_t)(abs(row - goalRow) + abs(col - goalCol));
+		return (k < INF ? k : (uint64_t)INF) << 32 | m;
+	}
+	void push(size_t cell) {
+		heap.push_back(Entry(key(cell), (uint32_t)cell));
+		std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+	}
+
+	template <class Grid>
+	void updateCell(const Grid& grid, int row, int col);
+	template <class Grid>
+	bool repair(const Grid& grid, MazePath& path);
+
+	int H, W;
+	size_t start, goal;
+	int goalRow, goalCol;
+	std::vector<uint32_t> g, rhs;
+	std::vector<Entry> heap;
+
+};
+
+template <class Grid>
+bool MazeLpa::solve(const Grid& grid, MazePath& path)
+{
+	expanded = touched = 0;
+	path.reset(grid.entranceRow, grid.entranceCol);
+	clear();
+	if (grid.empty())
+		return false;
+
+	H = grid.height();
+	W = grid.width();
+	start = grid.index(grid.entranceRow, grid.entranceCol);
+	goal = grid.index(grid.exitRow, grid.exitCol);
+	goalRow = grid.exitRow;
+	goalCol = grid.exitCol;
+	g.assign(grid.cellCount(), INF);
+	rhs.assign(grid.cellCount(), INF);
+	rhs[start] = 0;
+	push(start);
+	return repair(grid, path);
+}
+
+template <class Grid>
+bool MazeLpa::wallChanged(const Grid& grid, int row, int col, int dir, MazePath& path)
+{
+	if (!matches(grid))
+		return solve(grid, path);
+	expanded = touched = 0;
+	path.reset(grid.entranceRow, grid.entranceCol);
+
+	updateCell(grid, row, col);
+	int nr = row + MAZE_DROW[dir];
+	int nc = col + MAZE_DCOL[dir];
+	if (nr >= 0 && nr < H && nc >= 0 && nc < W)
+		updateCell(grid, nr, nc);
+	return repair(grid, path);
+}
+
+template <class Grid>
+void MazeLpa::updateCell(const Grid& grid, int row, int col)
+{
+	size_t cell = grid.index(row, col);
+	touched++;
+	if (cell != start) {
+		uint32_t best = INF;
+		for (int dir = 0; dir < 4; dir++) {
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr < 0 || nr >= H || nc < 0 || nc >= W || !grid.canMove(row, col, dir))
+				continue;
+			uint32_t d = g[grid.index(nr, nc)];
+			if (d != INF && d + 1 < best)
+				best = d + 1;
+		}
+		rhs[cell] = best;
+	}
+	if (g[cell] != rhs[cell])
+		push(cell);
+}
+
+template <class Grid>
+bool MazeLpa::repair(const Grid& grid, MazePath& path)
+{
+	std::greater<Entry> later;
+	for (;;) {
+		// Drop entries for cells that changed since they were queued
+		while (!heap.empty()) {
+			size_t top = heap.front().second;
+			if (g[top] != rhs[top] && heap.front().first == key(top))
+				break;
+			std::pop_heap(heap.begin(), heap.end(), later);
+			heap.pop_back();
+		}
+		if (heap.empty() || (heap.front().first >= key(goal) && g[goal] == rhs[goal]))
+			break;
+		if (cancel.poll()) {
+			clear();
+			return false;
+		}
+
+		size_t cur = heap.front().second;
+		std::pop_heap(heap.begin(), heap.end(), later);
+		heap.pop_back();
+		expanded++;
+
+		int row = (int)(cur / W);
+		int col = (int)(cur % W);
+		if (g[cur] > rhs[cur]) {
+			// Overconsistent: settle the lower distance
+			g[cur] = rhs[cur];
+		}
+		else {
+			// Underconsistent: the cell got farther, so raise it and let
+			// it and its neighbours find their distance again
+			g[cur] = INF;
+			updateCell(grid, row, col);
+		}
+		for (int dir = 0; dir < 4; dir++) {
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr >= 0 && nr < H && nc >= 0 && nc < W && grid.canMove(row, col, dir))
+				updateCell(grid, nr, nc);
+		}
+	}
+	if (g[goal] == INF)
+		return false;
+
+	// Walk back from the exit through the neighbour one step closer
+	size_t steps = g[goal];
+	path.resize(steps);
+	int row = goalRow, col = goalCol;
+	for (size_t i = steps; i > 0; i--) {
+		uint32_t want = g[grid.index(row, col)] - 1;
+		int back = -1;
+		for (int dir = 0; dir < 4 && back < 0; dir++) {
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr >= 0 && nr < H && nc >= 0 && nc < W && grid.canMove(row, col, dir)
+				&& g[grid.index(nr, nc)] == want)
+				back = dir;
+		}
+		path.set(i - 1, mazeOpposite(back));
+		row += MAZE_DROW[back];
+		col += MAZE_DCOL[back];
+	}
+	return true;
+}
@@ -0,0 +1,121 @@
+/*
+
+	mazeMappedFile.cpp
+
+*/
+#include "mazeMappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MazeMappedFile::MazeMappedFile()
+{
+	mapped = nullptr;
+	fileSize = 0;
+	fileOpen = false;
+#ifdef _WIN32
+	hFile = INVALID_HANDLE_VALUE;
+	hMapping = nullptr;
+#endif
+}
+
+MazeMappedFile::~MazeMappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool MazeMappedFile::open(const std::string& path)
+{
+	close();
+	hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+	fileOpen = true;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hFile, &size)) {
+		close();
+		return false;
+	}
+	fileSize = (size_t)size.QuadPart;
+	if (fileSize == 0)
+		return true;
+
+	hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!hMapping) {
+		close();
+		return false;
+	}
+	mapped = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!mapped) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MazeMappedFile::close()
+{
+	if (mapped) UnmapViewOfFile(mapped);
+	if (hMapping) CloseHandle(hMapping);
+	if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+	mapped = nullptr;
+	hMapping = nullptr;
+	hFile = INVALID_HANDLE_VALUE;
+	fileSize = 0;
+	fileOpen = false;
+}
+
+#else
+
+bool MazeMappedFile::open(const std::string& path)
+{
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return false;
+	}
+	fileOpen = true;
+	fileSize = (size_t)st.st_size;
+	if (fileSize == 0) {
+		::close(fd);
+		return true;
+	}
+
+	void* p = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file
+	::close(fd);
+	if (p == MAP_FAILED) {
+		fileSize = 0;
+		fileOpen = false;
+		return false;
+	}
+	// The text is read front to back exactly once
+	madvise(p, fileSize, MADV_SEQUENTIAL);
+	mapped = p;
+	return true;
+}
+
+void MazeMappedFile::close()
+{
+	if (mapped) munmap(mapped, fileSize);
+	mapped = nullptr;
+	fileSize = 0;
+	fileOpen = false;
+}
+
+#endif
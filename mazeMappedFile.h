@@ -0,0 +1,40 @@
+/*
+
+	mazeMappedFile.h
+
+	Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MazeMappedFile {
+
+public:
+
+	MazeMappedFile();
+	~MazeMappedFile();
+
+	bool open(const std::string& path);
+	void close();
+
+	bool isOpen() const { return mapped != nullptr || (fileOpen && fileSize == 0); }
+	const char* data() const { return (const char*)mapped; }
+	size_t size() const { return fileSize; }
+
+private:
+
+	MazeMappedFile(const MazeMappedFile&);
+	MazeMappedFile& operator=(const MazeMappedFile&);
+
+	void* mapped;
+	size_t fileSize;
+	bool fileOpen;
+#ifdef _WIN32
+	void* hFile;
+	void* hMapping;
+#endif
+
+};
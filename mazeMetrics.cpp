@@ -0,0 +1,98 @@
+/*
+
+	mazeMetrics.cpp
+
+*/
+#include "mazeMetrics.h"
+#include <cstdio>
+#include <mutex>
+
+namespace {
+
+// Function statics, so metrics in other files can register during their
+// static initialization whatever the order
+std::mutex& registryLock()
+{
+	static std::mutex lock;
+	return lock;
+}
+
+std::vector<MazeMetric*>& registry()
+{
+	static std::vector<MazeMetric*> metrics;
+	return metrics;
+}
+
+bool endsWith(const std::string& s, const char* suffix)
+{
+	size_t n = std::char_traits<char>::length(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}
+
+MazeMetric mazeMetricLoadUs("load.us");
+MazeMetric mazeMetricLoadBytes("load.bytes");
+MazeMetric mazeMetricGridBytes("grid.bytes");
+MazeMetric mazeMetricGridReservedBytes("grid.reserved.bytes");
+MazeMetric mazeMetricSolveUs("solve.us");
+MazeMetric mazeMetricSolveExpanded("solve.expanded");
+MazeMetric mazeMetricSolvePath("solve.path");
+
+MazeMetric::MazeMetric(const char* name) : label(name), n(0), sum(0), latest(0), largest(0)
+{
+	std::lock_guard<std::mutex> guard(registryLock());
+	registry().push_back(this);
+}
+
+void MazeMetric::reset()
+{
+	n.store(0, std::memory_order_relaxed);
+	sum.store(0, std::memory_order_relaxed);
+	latest.store(0, std::memory_order_relaxed);
+	largest.store(0, std::memory_order_relaxed);
+}
+
+std::vector<MazeMetric*> mazeMetrics()
+{
+	std::lock_guard<std::mutex> guard(registryLock());
+	return registry();
+}
+
+void mazeResetMetrics()
+{
+	std::vector<MazeMetric*> metrics = mazeMetrics();
+	for (size_t i = 0; i < metrics.size(); i++)
+		metrics[i]->reset();
+}
+
+bool mazeWriteMetrics(const std::string& file, std::string* error)
+{
+	FILE* fp = fopen(file.c_str(), "w");
+	if (!fp) {
+		if (error) *error = "cannot create file";
+		return false;
+	}
+	std::vector<MazeMetric*> metrics = mazeMetrics();
+	bool csv = endsWith(file, ".csv") || endsWith(file, ".CSV");
+	if (csv)
+		fprintf(fp, "name,count,total,last,max,mean\n");
+	else
+		fprintf(fp, "{\n  \"metrics\": [\n");
+	for (size_t i = 0; i < metrics.size(); i++) {
+		const MazeMetric& m = *metrics[i];
+		unsigned long long count = m.count(), total = m.total(), last = m.last(), max = m.max();
+		if (csv)
+			fprintf(fp, "%s,%llu,%llu,%llu,%llu,%.3f\n", m.name(), count, total, last, max, m.mean());
+		else
+			fprintf(fp, "    { \"name\": \"%s\", \"count\": %llu, \"total\": %llu, \"last\": %llu, \"max\": %llu, \"mean\": %.3f }%s\n",
+				m.name(), count, total, last, max, m.mean(), i + 1 < metrics.size() ? "," : "");
+	}
+	if (!csv)
+		fprintf(fp, "  ]\n}\n");
+	bool ok = !ferror(fp);
+	ok = fclose(fp) == 0 && ok;
+	if (!ok && error)
+		*error = "write failed";
+	return ok;
+}
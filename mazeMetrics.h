@@ -0,0 +1,104 @@
+/*
+
+	mazeMetrics.h
+
+	Named timers and counters recorded by the loader, the solve worker and
+	the app's renderer, for the info overlay and for dumps to JSON or CSV.
+
+	A metric is an object with static storage that registers itself once at
+	start-up. Recording a value costs a few relaxed atomic operations, with
+	no lookup and no lock, so metrics can be recorded in hot paths and from
+	any thread. Each metric keeps the number of values recorded, their sum,
+	the last value and the largest. Timers record microseconds.
+
+*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MazeMetric {
+
+public:
+
+	// name must outlive the metric; a string literal is expected
+	explicit MazeMetric(const char* name);
+
+	void record(uint64_t value)
+	{
+		n.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+		latest.store(value, std::memory_order_relaxed);
+		uint64_t top = largest.load(std::memory_order_relaxed);
+		while (value > top && !largest.compare_exchange_weak(top, value, std::memory_order_relaxed)) {
+		}
+	}
+
+	void reset();
+
+	const char* name() const { return label; }
+	uint64_t count() const { return n.load(std::memory_order_relaxed); }
+	uint64_t total() const { return sum.load(std::memory_order_relaxed); }
+	uint64_t last() const { return latest.load(std::memory_order_relaxed); }
+	uint64_t max() const { return largest.load(std::memory_order_relaxed); }
+	double mean() const { uint64_t c = count(); return c ? (double)total() / c : 0; }
+
+private:
+
+	MazeMetric(const MazeMetric&);
+	MazeMetric& operator=(const MazeMetric&);
+
+	const char* label;
+	std::atomic<uint64_t> n;
+	std::atomic<uint64_t> sum;
+	std::atomic<uint64_t> latest;
+	std::atomic<uint64_t> largest;
+
+};
+
+// Microseconds on a steady clock, for timing by hand
+inline uint64_t mazeMetricNowUs()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Records the microseconds from construction to destruction into a metric
+class MazeScopedTimer {
+
+public:
+
+	explicit MazeScopedTimer(MazeMetric& metric) : metric(metric), t0(mazeMetricNowUs()) {}
+	~MazeScopedTimer() { metric.record(mazeMetricNowUs() - t0); }
+
+private:
+
+	MazeScopedTimer(const MazeScopedTimer&);
+	MazeScopedTimer& operator=(const MazeScopedTimer&);
+
+	MazeMetric& metric;
+	uint64_t t0;
+
+};
+
+// Metrics recorded by the core
+extern MazeMetric mazeMetricLoadUs; // loadMazeFile, successful loads only
+extern MazeMetric mazeMetricLoadBytes; // size of each file loaded
+extern MazeMetric mazeMetricGridBytes; // wall storage of each grid loaded
+extern MazeMetric mazeMetricGridReservedBytes; // storage held by the grid after each load
+extern MazeMetric mazeMetricSolveUs; // MazeSolveWorker, finished solves only
+extern MazeMetric mazeMetricSolveExpanded;
+extern MazeMetric mazeMetricSolvePath; // steps of each path found
+
+// Every metric, in the order they registered
+std::vector<MazeMetric*> mazeMetrics();
+
+// Reset every metric
+void mazeResetMetrics();
+
+// Write every metric to file, as CSV if the name ends in .csv and as JSON
+// otherwise
+bool mazeWriteMetrics(const std::string& file, std::string* error = nullptr);
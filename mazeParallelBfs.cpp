@@ -0,0 +1,136 @@
+/*
+
+	mazeParallelBfs.cpp
+
+*/
+#include "mazeParallelBfs.h"
+
+MazeParallelBfs::MazeParallelBfs(int threads) : pool(threads)
+{
+	serialCutoff = 512;
+	expanded = 0;
+	levels = 0;
+	visitedWords = 0;
+	parentWords = 0;
+	current.resize(pool.size());
+	next.resize(pool.size());
+	found = false;
+}
+
+size_t MazeParallelBfs::memoryBytes() const
+{
+	size_t bytes = (visitedWords + parentWords) * sizeof(uint64_t);
+	for (size_t i = 0; i < current.size(); i++)
+		bytes += (current[i].capacity() + next[i].capacity()) * sizeof(uint64_t);
+	return bytes;
+}
+
+// Expand cells begin .. end - 1 of the current frontier, counted across
+// all parts, into next[part]
+void MazeParallelBfs::expandRange(const MazeGrid& grid, int part, size_t begin, size_t end, size_t goal)
+{
+	int H = grid.height();
+	int W = grid.width();
+	std::vector<uint64_t>& out = next[part];
+
+	size_t offset = 0;
+	for (size_t p = 0; p < current.size() && offset < end; offset += current[p].size(), p++) {
+		const std::vector<uint64_t>& cells = current[p];
+		size_t from = begin > offset ? begin - offset : 0;
+		size_t to = end - offset < cells.size() ? end - offset : cells.size();
+		for (size_t i = from; i < to; i++) {
+			uint64_t cur = cells[i];
+			int row = (int)(cur / W);
+			int col = (int)(cur % W);
+			for (int dir = 0; dir < 4; dir++) {
+				if (!grid.canMove(row, col, dir))
+					continue;
+				int nr = row + MAZE_DROW[dir];
+				int nc = col + MAZE_DCOL[dir];
+				if (nr < 0 || nr >= H || nc < 0 || nc >= W)
+					continue;
+				size_t cell = grid.index(nr, nc);
+				uint64_t mask = 1ULL << (cell & 63);
+				std::atomic<uint64_t>& word = visited[cell >> 6];
+				// Plain load first; most neighbours are already taken
+				if (word.load(std::memory_order_relaxed) & mask)
+					continue;
+				if (word.fetch_or(mask, std::memory_order_relaxed) & mask)
+					continue;
+				if (dir)
+					parent[cell >> 5].fetch_or((uint64_t)dir << ((cell & 31) * 2), std::memory_order_relaxed);
+				out.push_back(cell);
+				if (cell == goal)
+					found.store(true, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+bool MazeParallelBfs::solve(const MazeGrid& grid, MazePath& path)
+{
+	expanded = 0;
+	levels = 0;
+	path.reset(grid.entranceRow, grid.entranceCol);
+	if (grid.empty())
+		return false;
+
+	size_t cells = grid.cellCount();
+	size_t needVisited = (cells + 63) / 64;
+	size_t needParent = (cells + 31) / 32;
+	if (visitedWords < needVisited) {
+		visited.reset(new std::atomic<uint64_t>[needVisited]);
+		visitedWords = needVisited;
+	}
+	if (parentWords < needParent) {
+		parent.reset(new std::atomic<uint64_t>[needParent]);
+		parentWords = needParent;
+	}
+
+	// Clear both bitsets in parallel
+	int T = pool.size();
+	pool.run([&](int t) {
+		for (size_t i = needVisited * t / T; i < needVisited * (t + 1) / T; i++)
+			visited[i].store(0, std::memory_order_relaxed);
+		for (size_t i = needParent * t / T; i < needParent * (t + 1) / T; i++)
+			parent[i].store(0, std::memory_order_relaxed);
+	});
+
+	size_t start = grid.index(grid.entranceRow, grid.entranceCol);
+	size_t goal = grid.index(grid.exitRow, grid.exitCol);
+	for (int t = 0; t < T; t++) {
+		current[t].clear();
+		next[t].clear();
+	}
+	visited[start >> 6].store(1ULL << (start & 63), std::memory_order_relaxed);
+	current[0].push_back(start);
+	found = start == goal;
+
+	size_t total = 1;
+	while (total > 0 && !found.load()) {
+		if (cancel.now())
+			return false;
+		if (total < serialCutoff) {
+			expandRange(grid, 0, 0, total, goal);
+		}
+		else {
+			pool.run([&](int t) {
+				expandRange(grid, t, total * t / T, total * (t + 1) / T, goal);
+			});
+		}
+		expanded += total;
+		levels++;
+
+		current.swap(next);
+		total = 0;
+		for (int t = 0; t < T; t++) {
+			total += current[t].size();
+			next[t].clear();
+		}
+	}
+	if (!found.load())
+		return false;
+
+	mazeTraceBack(grid, [this](size_t cell) { return parentDir(cell); }, path);
+	return true;
+}
@@ -0,0 +1,69 @@
+/*
+
+	mazeParallelBfs.h
+
+	Level-synchronous breadth-first search on a thread pool.
+
+	Every level the frontier is split evenly across the threads. Each
+	thread claims neighbours with an atomic fetch_or on the shared visited
+	bitset, records the two-bit parent direction the same way, and appends
+	new cells to its own frontier part, so threads never share a queue.
+	Levels are separated by the pool's join, so the distances are exactly
+	those of MazeBfs.
+
+	Small frontiers are expanded on the calling thread; waking the pool
+	costs more than a few hundred cells.
+
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+#include "mazeThreadPool.h"
+
+class MazeParallelBfs {
+
+public:
+
+	// threads == 0 uses one thread per hardware thread
+	explicit MazeParallelBfs(int threads = 0);
+
+	// Find a shortest path from the entrance to the exit. Returns false if
+	// there is none, in which case path is left empty.
+	bool solve(const MazeGrid& grid, MazePath& path);
+
+	int threads() const { return pool.size(); }
+
+	// Frontiers smaller than this run on the calling thread only
+	size_t serialCutoff;
+
+	// Cells expanded and levels run by the last solve
+	size_t expanded;
+	size_t levels;
+
+	// Checked between levels; solve stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const;
+
+private:
+
+	void expandRange(const MazeGrid& grid, int part, size_t begin, size_t end, size_t goal);
+	int parentDir(size_t cell) const {
+		return (int)(parent[cell >> 5].load(std::memory_order_relaxed) >> ((cell & 31) * 2)) & 3;
+	}
+
+	MazeThreadPool pool;
+	std::unique_ptr<std::atomic<uint64_t>[]> visited; // 1 bit per cell
+	std::unique_ptr<std::atomic<uint64_t>[]> parent; // 2 bits per cell
+	size_t visitedWords, parentWords;
+	std::vector<std::vector<uint64_t> > current, next; // frontier, one part per thread
+	std::atomic<bool> found;
+
+};
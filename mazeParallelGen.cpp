@@ -0,0 +1,113 @@
+/*
+
+	mazeParallelGen.cpp
+
+*/
+#include "mazeParallelGen.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "mazeEller.h"
+#include "mazeThreadPool.h"
+
+namespace {
+
+// Seam between two neighbouring tiles, right or below of tile a
+struct Seam {
+	int a, b;
+	bool below;
+};
+
+int findTile(std::vector<int>& parent, int t)
+{
+	while (parent[t] != t) {
+		parent[t] = parent[parent[t]];
+		t = parent[t];
+	}
+	return t;
+}
+
+}
+
+void generateMazeParallel(MazeGrid& grid, int height, int width, uint64_t seed, int threads, int tileSize)
+{
+	if (height <= 0 || width <= 0) {
+		grid.clear();
+		return;
+	}
+	int tile = tileSize < 64 ? 64 : (tileSize + 63) / 64 * 64;
+	int tileRows = (height + tile - 1) / tile;
+	int tileCols = (width + tile - 1) / tile;
+	int tiles = tileRows * tileCols;
+
+	grid.resize(height, width);
+	MazeThreadPool pool(threads);
+	int T = pool.size();
+
+	// Every wall on, in bands of rows per thread
+	pool.run([&](int t) {
+		for (int r = (int)((long long)(height + 1) * t / T); r < (int)((long long)(height + 1) * (t + 1) / T); r++) {
+			memset(grid.hRow(r), 0xFF, grid.hRowWords() * sizeof(uint64_t));
+			if (r < height)
+				memset(grid.vRow(r), 0xFF, grid.vRowWords() * sizeof(uint64_t));
+		}
+	});
+
+	// Each tile carves its own perfect maze, tiles handed out in turn
+	std::atomic<int> nextTile(0);
+	pool.run([&](int) {
+		for (int t = nextTile++; t < tiles; t = nextTile++) {
+			int r0 = t / tileCols * tile;
+			int c0 = t % tileCols * tile;
+			int th = std::min(tile, height - r0);
+			int tw = std::min(tile, width - c0);
+			MazeEller eller(tw, MazeRandom(seed ^ (0x9E3779B97F4A7C15ULL * (t + 1))).next());
+			// Open walls of one row as bits, then cleared a word at a time
+			std::vector<uint64_t> right((tw + 63) / 64), down((tw + 63) / 64);
+			for (int i = 0; i < th; i++) {
+				const uint8_t* walls = eller.nextRow(i == th - 1);
+				std::fill(right.begin(), right.end(), 0);
+				std::fill(down.begin(), down.end(), 0);
+				for (int j = 0; j + 1 < tw; j++)
+					right[(j + 1) >> 6] |= (uint64_t)!(walls[j] & WALL_RIGHT) << ((j + 1) & 63);
+				for (int j = 0; j < tw; j++)
+					down[j >> 6] |= (uint64_t)!(walls[j] & WALL_DOWN) << (j & 63);
+				uint64_t* v = grid.vRow(r0 + i) + (c0 >> 6);
+				for (size_t w = 0; w < right.size(); w++)
+					v[w] &= ~right[w];
+				uint64_t* h = grid.hRow(r0 + i + 1) + (c0 >> 6);
+				for (size_t w = 0; w < down.size(); w++)
+					h[w] &= ~down[w];
+			}
+		}
+	});
+
+	// Random spanning tree over the tiles, one door per tree edge
+	std::vector<Seam> seams;
+	for (int t = 0; t < tiles; t++) {
+		if (t % tileCols + 1 < tileCols)
+			seams.push_back({ t, t + 1, false });
+		if (t / tileCols + 1 < tileRows)
+			seams.push_back({ t, t + tileCols, true });
+	}
+	MazeRandom random(seed);
+	for (size_t i = seams.size(); i > 1; i--)
+		std::swap(seams[i - 1], seams[random.below((uint32_t)i)]);
+
+	std::vector<int> parent(tiles);
+	for (int t = 0; t < tiles; t++)
+		parent[t] = t;
+	for (size_t i = 0; i < seams.size(); i++) {
+		int a = findTile(parent, seams[i].a), b = findTile(parent, seams[i].b);
+		if (a == b)
+			continue;
+		parent[b] = a;
+		int r0 = seams[i].b / tileCols * tile;
+		int c0 = seams[i].b % tileCols * tile;
+		if (seams[i].below)
+			grid.setHWall(r0, c0 + (int)random.below(std::min(tile, width - c0)), false);
+		else
+			grid.setVWall(r0 + (int)random.below(std::min(tile, height - r0)), c0, false);
+	}
+}
@@ -0,0 +1,27 @@
+/*
+
+	mazeParallelGen.h
+
+	Perfect maze generation split into tiles, one tile per task on a thread
+	pool.
+
+	Every tile is made a perfect maze of its own with MazeEller. The tiles
+	are then joined by a random spanning tree of the tile grid: each tree
+	edge opens exactly one door in the seam between its two tiles. A tree
+	of trees joined by single edges is again a tree, so the whole grid is a
+	perfect maze with one path between any two cells.
+
+	The grid starts with every wall set and tiles only remove walls inside
+	themselves. Tile widths are multiples of 64, so no two tiles write the
+	same bitplane word and the threads need no locks.
+
+*/
+#pragma once
+
+#include <cstdint>
+#include "mazeGrid.h"
+
+// Generate a height x width perfect maze into grid. threads == 0 uses one
+// thread per hardware thread. tileSize is rounded up to a multiple of 64.
+// The same seed and tileSize give the same maze for any thread count.
+void generateMazeParallel(MazeGrid& grid, int height, int width, uint64_t seed, int threads = 0, int tileSize = 1024);
@@ -0,0 +1,155 @@
+/*
+
+	mazePath.h
+
+	A path stored as its start cell and one MazeDir per step, packed two
+	bits per step. A path over 10^8 cells takes 25 MB.
+
+	MazeDirArray keeps one MazeDir per cell the same way, for the
+	parent links of the searches.
+
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "mazeGrid.h"
+
+class MazePath {
+
+public:
+
+	MazePath() : startRow(0), startCol(0), steps(0) {}
+
+	// Empty path starting at (row, col)
+	void reset(int row, int col) {
+		startRow = row;
+		startCol = col;
+		steps = 0;
+	}
+	void clear() { reset(0, 0); }
+
+	// Make room for n steps so push() never allocates
+	void reserve(size_t n) {
+		size_t words = (n + 31) / 32;
+		if (bits.size() < words)
+			bits.resize(words);
+	}
+
+	void push(int dir) {
+		size_t w = steps >> 5;
+		int shift = (int)(steps & 31) * 2;
+		if (w >= bits.size())
+			bits.resize(bits.size() * 2 + 1);
+		bits[w] = (bits[w] & ~(3ULL << shift)) | ((uint64_t)dir << shift);
+		steps++;
+	}
+	int pop() { steps--; return at(steps); }
+
+	// Set the number of steps; new steps are filled in with set()
+	void resize(size_t n) {
+		reserve(n);
+		steps = n;
+	}
+	void set(size_t i, int dir) {
+		int shift = (int)(i & 31) * 2;
+		bits[i >> 5] = (bits[i >> 5] & ~(3ULL << shift)) | ((uint64_t)dir << shift);
+	}
+	int at(size_t i) const { return (int)(bits[i >> 5] >> ((i & 31) * 2)) & 3; }
+	int last() const { return at(steps - 1); }
+
+	// Direction of step i
+	int operator[](size_t i) const { return at(i); }
+
+	bool empty() const { return steps == 0; }
+	// Number of steps. The path visits size() + 1 cells.
+	size_t size() const { return steps; }
+
+	int startRow, startCol;
+
+	// Cell at the end of the path
+	void end(int& row, int& col) const {
+		row = startRow;
+		col = startCol;
+		for (size_t i = 0; i < steps; i++) {
+			row += MAZE_DROW[at(i)];
+			col += MAZE_DCOL[at(i)];
+		}
+	}
+
+	// Copy other's steps. Only the words in use are copied, so a path with
+	// room reserved for a whole maze copies as cheaply as any other.
+	void assign(const MazePath& other) {
+		startRow = other.startRow;
+		startCol = other.startCol;
+		resize(other.steps);
+		std::copy(other.bits.begin(), other.bits.begin() + (other.steps + 31) / 32, bits.begin());
+	}
+
+	// Exchange contents with other without copying the steps
+	void swap(MazePath& other) {
+		std::swap(startRow, other.startRow);
+		std::swap(startCol, other.startCol);
+		std::swap(steps, other.steps);
+		bits.swap(other.bits);
+	}
+
+	size_t memoryBytes() const { return bits.capacity() * sizeof(uint64_t); }
+
+private:
+
+	std::vector<uint64_t> bits;
+	size_t steps;
+
+};
+
+class MazeDirArray {
+
+public:
+
+	// Size for n cells. Old contents are kept; searches only read cells
+	// they have written.
+	void reset(size_t n) {
+		if (bits.size() < (n + 31) / 32)
+			bits.resize((n + 31) / 32);
+	}
+
+	int get(size_t i) const { return (int)(bits[i >> 5] >> ((i & 31) * 2)) & 3; }
+	void set(size_t i, int dir) {
+		int shift = (int)(i & 31) * 2;
+		bits[i >> 5] = (bits[i >> 5] & ~(3ULL << shift)) | ((uint64_t)dir << shift);
+	}
+
+	size_t memoryBytes() const { return bits.capacity() * sizeof(uint64_t); }
+
+private:
+
+	std::vector<uint64_t> bits;
+
+};
+
+// Fill path from the entrance to the exit by following parent directions
+// back from the exit. dirAt(cell) is the direction the cell was entered by.
+template <class Grid, class DirAt>
+void mazeTraceBack(const Grid& grid, DirAt dirAt, MazePath& path)
+{
+	// Once to count the steps, then again to fill the path from its end
+	size_t steps = 0;
+	for (int row = grid.exitRow, col = grid.exitCol; row != grid.entranceRow || col != grid.entranceCol; steps++) {
+		int dir = dirAt(grid.index(row, col));
+		row -= MAZE_DROW[dir];
+		col -= MAZE_DCOL[dir];
+	}
+	path.reset(grid.entranceRow, grid.entranceCol);
+	path.resize(steps);
+	int row = grid.exitRow, col = grid.exitCol;
+	for (size_t i = steps; i > 0; i--) {
+		int dir = dirAt(grid.index(row, col));
+		path.set(i - 1, dir);
+		row -= MAZE_DROW[dir];
+		col -= MAZE_DCOL[dir];
+	}
+}
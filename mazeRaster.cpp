@@ -0,0 +1,38 @@
+/*
+
+	mazeRaster.cpp
+
+*/
+#include "mazeRaster.h"
+
+// True if any wall meets the post at wall row r, wall column c
+static bool post(const MazeGrid& grid, int r, int c)
+{
+	int H = grid.height(), W = grid.width();
+	return (c > 0 && grid.hWall(r, c - 1)) || (c < W && grid.hWall(r, c))
+		|| (r > 0 && grid.vWall(r - 1, c)) || (r < H && grid.vWall(r, c));
+}
+
+void mazeRasterize(const MazeGrid& grid, int row0, int col0, int row1, int col1,
+	uint8_t wall, uint8_t open, uint8_t* out, size_t stride)
+{
+	for (int r = row0; r <= row1; r++) {
+		// Posts and horizontal walls on wall row r
+		uint8_t* line = out + (size_t)(r - row0) * 2 * stride;
+		for (int c = col0; c < col1; c++) {
+			line[2 * (c - col0)] = post(grid, r, c) ? wall : open;
+			line[2 * (c - col0) + 1] = grid.hWall(r, c) ? wall : open;
+		}
+		line[2 * (col1 - col0)] = post(grid, r, col1) ? wall : open;
+		if (r == row1)
+			break;
+
+		// Vertical walls and cells of row r
+		line += stride;
+		for (int c = col0; c < col1; c++) {
+			line[2 * (c - col0)] = grid.vWall(r, c) ? wall : open;
+			line[2 * (c - col0) + 1] = open;
+		}
+		line[2 * (col1 - col0)] = grid.vWall(r, col1) ? wall : open;
+	}
+}
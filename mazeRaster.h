@@ -0,0 +1,24 @@
+/*
+
+	mazeRaster.h
+
+	Pixel images of a maze, for textures and image files.
+
+	A cell is one pixel and so is each wall between two cells, so a block
+	of rows x cols cells is (2 cols + 1) x (2 rows + 1) pixels: the cell at
+	(r, c) is pixel (2c + 1, 2r + 1), its top wall (2c + 1, 2r) and its
+	left wall (2c, 2r + 1). Even-even pixels are the posts where walls
+	meet; a post is drawn when any wall touches it.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "mazeGrid.h"
+
+// Draw the cells in rows [row0, row1) and columns [col0, col1) into out,
+// one byte per pixel, stride bytes per pixel row. Walls get the value
+// wall and everything else open.
+void mazeRasterize(const MazeGrid& grid, int row0, int col0, int row1, int col1,
+	uint8_t wall, uint8_t open, uint8_t* out, size_t stride);
@@ -0,0 +1,111 @@
+/*
+
+	mazeSolveWorker.cpp
+
+*/
+#include "mazeSolveWorker.h"
+#include <cstring>
+#include "mazeMetrics.h"
+
+namespace {
+
+// Steps per slice between progress updates and cancellation checks
+const size_t SLICE = 16384;
+
+}
+
+MazeSolveWorker::MazeSolveWorker() : state(IDLE), cancelled(false), progress(0), elapsedUs(0), current(nullptr), found(false), stopped(false)
+{
+}
+
+MazeSolveWorker::~MazeSolveWorker()
+{
+	wait();
+}
+
+void MazeSolveWorker::start(const MazeGrid& grid, MazeSolver& solver)
+{
+	wait();
+	cancelled.store(false, std::memory_order_relaxed);
+	progress.store(0, std::memory_order_relaxed);
+	elapsedUs.store(0, std::memory_order_relaxed);
+	current = &solver;
+	found = stopped = false;
+	state.store(RUNNING, std::memory_order_release);
+	thread = std::thread(&MazeSolveWorker::run, this, &grid, &solver);
+}
+
+void MazeSolveWorker::wait()
+{
+	if (!thread.joinable())
+		return;
+	cancel();
+	thread.join();
+	state.store(IDLE, std::memory_order_release);
+}
+
+bool MazeSolveWorker::take(MazePath& path)
+{
+	if (!finished())
+		return false;
+	if (thread.joinable())
+		thread.join();
+	path.swap(result);
+	state.store(IDLE, std::memory_order_release);
+	return found;
+}
+
+void MazeSolveWorker::run(const MazeGrid* grid, MazeSolver* solver)
+{
+	uint64_t t0 = mazeMetricNowUs();
+	const char* name = solver->name();
+	MazeStepSearch::Kind kind = MazeStepSearch::DFS;
+	bool stepped = true;
+	if (strcmp(name, "dfs") == 0)
+		kind = MazeStepSearch::DFS;
+	else if (strcmp(name, "bfs") == 0)
+		kind = MazeStepSearch::BFS;
+	else if (strcmp(name, "astar") == 0)
+		kind = MazeStepSearch::ASTAR;
+	else
+		stepped = false;
+
+	if (stepped) {
+		search.start(*grid, kind);
+		for (;;) {
+			bool more = search.step(*grid, SLICE);
+			// Nobody watches the frontier here
+			search.opened.clear();
+			search.closed.clear();
+			progress.store(search.expanded, std::memory_order_relaxed);
+			elapsedUs.store(mazeMetricNowUs() - t0, std::memory_order_relaxed);
+			if (!more || cancelled.load(std::memory_order_relaxed))
+				break;
+		}
+		stopped = search.running();
+		found = search.found();
+		if (found)
+			search.takePath(*grid, result);
+		search.stop();
+	}
+	else {
+		solver->setCancel(&cancelled);
+		found = solver->solve(*grid, result);
+		solver->setCancel(nullptr);
+		progress.store(solver->nodesExpanded(), std::memory_order_relaxed);
+		// Also drops a result that was found just as the cancel came in
+		stopped = cancelled.load(std::memory_order_relaxed);
+		found = found && !stopped;
+	}
+	if (!found)
+		result.reset(grid->entranceRow, grid->entranceCol);
+	uint64_t us = mazeMetricNowUs() - t0;
+	elapsedUs.store(us, std::memory_order_relaxed);
+	if (!stopped) {
+		mazeMetricSolveUs.record(us);
+		mazeMetricSolveExpanded.record(progress.load(std::memory_order_relaxed));
+		if (found)
+			mazeMetricSolvePath.record(result.size());
+	}
+	state.store(DONE, std::memory_order_release);
+}
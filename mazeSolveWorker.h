@@ -0,0 +1,92 @@
+/*
+
+	mazeSolveWorker.h
+
+	Runs one solve at a time on a background thread, so the app can keep
+	drawing while a large maze is searched.
+
+	Progress is published through atomics that any thread can read while
+	the solve runs: cells expanded so far and the time spent. dfs, bfs and
+	astar run as MazeStepSearch in slices, publishing progress and checking
+	for cancellation after every slice. Other solvers run in one call and
+	report once at the end; they watch the cancel flag from inside their
+	search loop, so wait() does not block on them either.
+
+	The found path is built in a buffer owned by the worker and swapped
+	out by take(), so it is never copied.
+
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include "mazeGrid.h"
+#include "mazePath.h"
+#include "mazeSolver.h"
+#include "mazeStepSearch.h"
+
+class MazeSolveWorker {
+
+public:
+
+	MazeSolveWorker();
+	~MazeSolveWorker();
+
+	// Start solving grid with solver, cancelling and waiting for any solve
+	// still running. grid and solver must not change or go away until the
+	// solve has finished or wait() has returned.
+	void start(const MazeGrid& grid, MazeSolver& solver);
+
+	// Ask the running solve to stop. Returns at once; finished() turns true
+	// when it has stopped, and take() then returns false.
+	void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+	// Cancel and block until the thread has stopped. Drops any result not
+	// yet taken, so the grid can be changed afterwards.
+	void wait();
+
+	// True from start() until take() has been called on a finished solve
+	bool busy() const { return state.load(std::memory_order_acquire) != IDLE; }
+	// True once the solve is over and its result can be taken
+	bool finished() const { return state.load(std::memory_order_acquire) == DONE; }
+
+	// Progress of the current or last solve
+	size_t expanded() const { return (size_t)progress.load(std::memory_order_relaxed); }
+	double elapsedMs() const { return elapsedUs.load(std::memory_order_relaxed) / 1000.0; }
+
+	// Solver of the current or last solve
+	MazeSolver* solver() const { return current; }
+
+	// After finished(): swap the path into path and return whether one was
+	// found. path's old buffer is kept for the next solve. The worker is
+	// idle afterwards.
+	bool take(MazePath& path);
+
+	// After finished(): true if the solve was cancelled before it finished
+	bool wasCancelled() const { return stopped; }
+
+private:
+
+	MazeSolveWorker(const MazeSolveWorker&);
+	MazeSolveWorker& operator=(const MazeSolveWorker&);
+
+	enum State { IDLE, RUNNING, DONE };
+
+	void run(const MazeGrid* grid, MazeSolver* solver);
+
+	std::thread thread;
+	std::atomic<int> state;
+	std::atomic<bool> cancelled;
+	std::atomic<uint64_t> progress;
+	std::atomic<uint64_t> elapsedUs;
+
+	// Written by the thread before state turns DONE, read after
+	MazeStepSearch search;
+	MazePath result;
+	MazeSolver* current;
+	bool found;
+	bool stopped;
+
+};
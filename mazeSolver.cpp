@@ -0,0 +1,119 @@
+/*
+
+	mazeSolver.cpp
+
+*/
+#include "mazeSolver.h"
+#include "mazeAstar.h"
+#include "mazeBfs.h"
+#include "mazeBidirectional.h"
+#include "mazeDfs.h"
+#include "mazeJps.h"
+#include "mazeLpa.h"
+#include "mazeParallelBfs.h"
+#include "mazeWaveBfs.h"
+
+namespace {
+
+// Wraps an engine with solve(grid, path) and an expanded count
+template <class Engine>
+class EngineSolver : public MazeSolver {
+
+public:
+
+	EngineSolver(const char* name, bool shortest) : label(name), exact(shortest) {}
+
+	const char* name() const override { return label; }
+	bool solve(const MazeGrid& grid, MazePath& path) override { return engine.solve(grid, path); }
+	void setCancel(const std::atomic<bool>* flag) override { engine.cancel.watch(flag); }
+	bool shortest() const override { return exact; }
+	size_t nodesExpanded() const override { return engine.expanded; }
+	size_t memoryBytes() const override { return engine.memoryBytes(); }
+
+	Engine engine;
+
+private:
+
+	const char* label;
+	bool exact;
+
+};
+
+// The thread pool is sized once, so pbfs is built with its thread count
+class ParallelBfsSolver : public MazeSolver {
+
+public:
+
+	explicit ParallelBfsSolver(int threads) : pbfs(threads) {}
+
+	const char* name() const override { return "pbfs"; }
+	bool solve(const MazeGrid& grid, MazePath& path) override { return pbfs.solve(grid, path); }
+	void setCancel(const std::atomic<bool>* flag) override { pbfs.cancel.watch(flag); }
+	bool shortest() const override { return true; }
+	size_t nodesExpanded() const override { return pbfs.expanded; }
+	size_t memoryBytes() const override { return pbfs.memoryBytes(); }
+
+private:
+
+	MazeParallelBfs pbfs;
+
+};
+
+// Runs an LPA* engine owned by the caller
+class LpaSolver : public MazeSolver {
+
+public:
+
+	explicit LpaSolver(MazeLpa& lpa) : lpa(lpa) {}
+
+	const char* name() const override { return "lpa"; }
+	bool solve(const MazeGrid& grid, MazePath& path) override { return lpa.solve(grid, path); }
+	void setCancel(const std::atomic<bool>* flag) override { lpa.cancel.watch(flag); }
+	bool shortest() const override { return true; }
+	size_t nodesExpanded() const override { return lpa.expanded; }
+	size_t memoryBytes() const override { return lpa.memoryBytes(); }
+
+private:
+
+	MazeLpa& lpa;
+
+};
+
+}
+
+const std::vector<std::string>& mazeSolverNames()
+{
+	static const std::vector<std::string> names = { "dfs", "bfs", "wave", "wave-s", "pbfs", "astar", "jps", "bibfs", "biastar", "lpa" };
+	return names;
+}
+
+MazeSolver* createMazeSolver(const std::string& name, int threads)
+{
+	if (name == "dfs")
+		return new EngineSolver<MazeDfs>("dfs", false);
+	if (name == "bfs")
+		return new EngineSolver<MazeBfs>("bfs", true);
+	if (name == "wave" || name == "wave-s") {
+		EngineSolver<MazeWaveBfs>* wave = new EngineSolver<MazeWaveBfs>(name == "wave" ? "wave" : "wave-s", true);
+		wave->engine.useSimd = name == "wave";
+		return wave;
+	}
+	if (name == "pbfs")
+		return new ParallelBfsSolver(threads);
+	if (name == "astar")
+		return new EngineSolver<MazeAstar>("astar", true);
+	if (name == "jps")
+		return new EngineSolver<MazeJps>("jps", true);
+	if (name == "bibfs")
+		return new EngineSolver<MazeBiBfs>("bibfs", true);
+	if (name == "biastar")
+		return new EngineSolver<MazeBiAstar>("biastar", true);
+	if (name == "lpa")
+		return new EngineSolver<MazeLpa>("lpa", true);
+	return nullptr;
+}
+
+MazeSolver* createLpaSolver(MazeLpa& lpa)
+{
+	return new LpaSolver(lpa);
+}
@@ -0,0 +1,63 @@
+/*
+
+	mazeSolver.h
+
+	Common interface over the path search engines, so the app and tools can
+	pick one by name and report on it the same way.
+
+	The engines themselves stay templates over the grid type; this wraps
+	them for MazeGrid. Names are dfs, bfs, wave, wave-s (wave without
+	SIMD), pbfs, astar, jps, bibfs and biastar (bidirectional), and lpa
+	(incremental A*; through this interface every solve starts over).
+
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeLpa;
+
+class MazeSolver {
+
+public:
+
+	virtual ~MazeSolver() {}
+
+	virtual const char* name() const = 0;
+
+	// Find a path from the entrance to the exit. Returns false if there is
+	// none, in which case path is left empty.
+	virtual bool solve(const MazeGrid& grid, MazePath& path) = 0;
+
+	// Make solve stop early, returning false, once flag turns true; pass
+	// nullptr to stop watching. solve checks it from inside its main loop,
+	// so another thread can cancel a long search.
+	virtual void setCancel(const std::atomic<bool>* flag) = 0;
+
+	// True if solve always returns a shortest path
+	virtual bool shortest() const = 0;
+
+	// Cells (or jump points) expanded by the last solve
+	virtual size_t nodesExpanded() const = 0;
+
+	// Bytes held between solves
+	virtual size_t memoryBytes() const = 0;
+
+};
+
+// Create the solver with the given name, or return nullptr if there is
+// none. threads is used by pbfs (0 = all hardware threads).
+MazeSolver* createMazeSolver(const std::string& name, int threads = 0);
+
+// Names accepted by createMazeSolver
+const std::vector<std::string>& mazeSolverNames();
+
+// Solver over an LPA* engine the caller owns, so its first search can run
+// on a MazeSolveWorker and later edits be repaired with lpa.wallChanged.
+// lpa must outlive the solver.
+MazeSolver* createLpaSolver(MazeLpa& lpa);
@@ -0,0 +1,132 @@
+/*
+
+	mazeStepSearch.h
+
+	DFS, BFS or A* from the entrance to the exit as a resumable search, for
+	showing a search as it runs.
+
+	start() sets a search up and step() advances it by a bounded number of
+	steps, returning once it has used them up or the search has finished.
+	The searching is done by MazeDfs, MazeBfs and MazeAstar, which keep
+	their state between calls; this only picks one and passes calls on, so
+	a stepped search expands the same cells as a solve() and finds the same
+	path.
+
+	Each step records the cells that joined the frontier in opened and the
+	cells that left it in closed, in the order it happened. The caller takes
+	them between steps and clears them, so it only ever sees what is new.
+	For BFS and A* the frontier is the open list; for DFS it is the current
+	stack, and a cell is closed when the search backs out of it.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mazeAstar.h"
+#include "mazeBfs.h"
+#include "mazeDfs.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeStepSearch {
+
+public:
+
+	enum Kind { DFS, BFS, ASTAR };
+
+	MazeStepSearch() : expanded(0), kind(BFS)
+	{
+		dfs.opened = bfs.opened = astar.opened = &opened;
+		dfs.closed = bfs.closed = astar.closed = &closed;
+	}
+
+	// Set up a search from the entrance to the exit. Clears opened and closed.
+	template <class Grid>
+	void start(const Grid& grid, Kind searchKind)
+	{
+		stop();
+		kind = searchKind;
+		opened.clear();
+		closed.clear();
+		if (kind == DFS)
+			dfs.start(grid);
+		else if (kind == BFS)
+			bfs.start(grid);
+		else
+			astar.start(grid);
+		expanded = count();
+	}
+
+	// Advance the search by up to maxSteps steps: one cell expanded for BFS
+	// and A*, one move forward or back for DFS. Returns true while the
+	// search has more to do. grid must not change while a search runs.
+	template <class Grid>
+	bool step(const Grid& grid, size_t maxSteps)
+	{
+		bool more = kind == DFS ? dfs.step(grid, maxSteps)
+			: kind == BFS ? bfs.step(grid, maxSteps) : astar.step(grid, maxSteps);
+		expanded = count();
+		return more;
+	}
+
+	// Abandon the search
+	void stop()
+	{
+		dfs.stop();
+		bfs.stop();
+		astar.stop();
+	}
+
+	bool running() const { return kind == DFS ? dfs.running() : kind == BFS ? bfs.running() : astar.running(); }
+	bool done() const { return kind == DFS ? dfs.done() : kind == BFS ? bfs.done() : astar.done(); }
+	bool found() const { return kind == DFS ? dfs.found() : kind == BFS ? bfs.found() : astar.found(); }
+	Kind searchKind() const { return kind; }
+
+	// The path found, once found() is true
+	template <class Grid>
+	void path(const Grid& grid, MazePath& out) const
+	{
+		if (kind == DFS)
+			dfs.path(grid, out);
+		else if (kind == BFS)
+			bfs.path(grid, out);
+		else
+			astar.path(grid, out);
+	}
+
+	// The same, but a DFS path is swapped out of the search rather than
+	// copied. The search is stopped.
+	template <class Grid>
+	void takePath(const Grid& grid, MazePath& out)
+	{
+		if (kind == DFS)
+			dfs.takePath(grid, out);
+		else
+			path(grid, out);
+		stop();
+	}
+
+	// Cells that joined and left the frontier since the caller last cleared them
+	std::vector<uint64_t> opened;
+	std::vector<uint64_t> closed;
+
+	// Cells expanded so far
+	size_t expanded;
+
+	size_t memoryBytes() const { return dfs.memoryBytes() + bfs.memoryBytes() + astar.memoryBytes(); }
+
+private:
+
+	MazeStepSearch(const MazeStepSearch&);
+	MazeStepSearch& operator=(const MazeStepSearch&);
+
+	size_t count() const { return kind == DFS ? dfs.expanded : kind == BFS ? bfs.expanded : astar.expanded; }
+
+	Kind kind;
+	MazeDfs dfs;
+	MazeBfs bfs;
+	MazeAstar astar;
+
+};
@@ -0,0 +1,76 @@
+/*
+
+	mazeThreadPool.cpp
+
+*/
+#include "mazeThreadPool.h"
+
+MazeThreadPool::MazeThreadPool(int threads)
+{
+	count = threads > 0 ? threads : hardwareThreads();
+	job = nullptr;
+	generation = 0;
+	pending = 0;
+	quit = false;
+	for (int i = 1; i < count; i++)
+		workers.push_back(std::thread(&MazeThreadPool::worker, this, i));
+}
+
+MazeThreadPool::~MazeThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		quit = true;
+	}
+	wake.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+int MazeThreadPool::hardwareThreads()
+{
+	int n = (int)std::thread::hardware_concurrency();
+	return n > 0 ? n : 1;
+}
+
+void MazeThreadPool::run(const std::function<void(int)>& fn)
+{
+	if (count == 1) {
+		fn(0);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		job = &fn;
+		pending = count - 1;
+		generation++;
+	}
+	wake.notify_all();
+	fn(0);
+
+	std::unique_lock<std::mutex> guard(lock);
+	done.wait(guard, [this] { return pending == 0; });
+	job = nullptr;
+}
+
+void MazeThreadPool::worker(int index)
+{
+	unsigned long long seen = 0;
+	for (;;) {
+		const std::function<void(int)>* fn;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			wake.wait(guard, [&] { return quit || generation != seen; });
+			if (quit)
+				return;
+			seen = generation;
+			fn = job;
+		}
+		(*fn)(index);
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (--pending == 0)
+				done.notify_one();
+		}
+	}
+}
@@ -0,0 +1,50 @@
+/*
+
+	mazeThreadPool.h
+
+	Fixed set of worker threads that run one job on every thread and wait
+	for all of them, for level-synchronous and banded work.
+
+*/
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class MazeThreadPool {
+
+public:
+
+	// threads == 0 uses one thread per hardware thread
+	explicit MazeThreadPool(int threads = 0);
+	~MazeThreadPool();
+
+	int size() const { return count; }
+
+	// Run job(index) for index 0 .. size() - 1 and wait for all of them.
+	// Index 0 runs on the calling thread.
+	void run(const std::function<void(int)>& job);
+
+	static int hardwareThreads();
+
+private:
+
+	MazeThreadPool(const MazeThreadPool&);
+	MazeThreadPool& operator=(const MazeThreadPool&);
+
+	void worker(int index);
+
+	int count;
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(int)>* job;
+	unsigned long long generation;
+	int pending;
+	bool quit;
+
+};
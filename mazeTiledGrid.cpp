@@ -0,0 +1,515 @@
+/*
+
+	mazeTiledGrid.cpp
+
+*/
+#include "mazeTiledGrid.h"
+#include "mazeBinary.h"
+#include "mazeLoader.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+static const char MAZE_TILED_MAGIC[4] = { 'M', 'A', 'Z', 'T' };
+
+static bool fail(std::string* error, const char* msg)
+{
+	if (error) *error = msg;
+	return false;
+}
+
+static bool seekTo(FILE* fp, uint64_t offset)
+{
+#ifdef _WIN32
+	return _fseeki64(fp, (long long)offset, SEEK_SET) == 0;
+#else
+	return fseeko(fp, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+static uint64_t fileSize(FILE* fp)
+{
+#ifdef _WIN32
+	if (_fseeki64(fp, 0, SEEK_END) != 0) return 0;
+	return (uint64_t)_ftelli64(fp);
+#else
+	if (fseeko(fp, 0, SEEK_END) != 0) return 0;
+	return (uint64_t)ftello(fp);
+#endif
+}
+
+static int roundTile(int tileSize)
+{
+	int tile = 2;
+	while (tile < tileSize && tile < (1 << 15))
+		tile *= 2;
+	return tile;
+}
+
+bool isMazeTiled(const char* data, size_t size)
+{
+	return size >= MAZE_TILED_HEADER_BYTES && memcmp(data, MAZE_TILED_MAGIC, 4) == 0;
+}
+
+void mazeTiledEncodeHeader(const MazeTiledHeader& header, uint8_t out[MAZE_TILED_HEADER_BYTES])
+{
+	memcpy(out, header.magic, 4);
+	mazePut16(out + 4, header.version);
+	mazePut16(out + 6, header.headerSize);
+	mazePut32(out + 8, header.height);
+	mazePut32(out + 12, header.width);
+	mazePut32(out + 16, header.tileSize);
+	mazePut32(out + 20, header.entranceRow);
+	mazePut32(out + 24, header.entranceCol);
+	mazePut32(out + 28, header.exitRow);
+	mazePut32(out + 32, header.exitCol);
+	mazePut32(out + 36, header.reserved);
+}
+
+void mazeTiledDecodeHeader(const uint8_t in[MAZE_TILED_HEADER_BYTES], MazeTiledHeader& header)
+{
+	memcpy(header.magic, in, 4);
+	header.version = mazeGet16(in + 4);
+	header.headerSize = mazeGet16(in + 6);
+	header.height = mazeGet32(in + 8);
+	header.width = mazeGet32(in + 12);
+	header.tileSize = mazeGet32(in + 16);
+	header.entranceRow = mazeGet32(in + 20);
+	header.entranceCol = mazeGet32(in + 24);
+	header.exitRow = mazeGet32(in + 28);
+	header.exitCol = mazeGet32(in + 32);
+	header.reserved = mazeGet32(in + 36);
+}
+
+//--------------------------------------------------------------
+MazeTiledWriter::MazeTiledWriter()
+{
+	fp = nullptr;
+	HEIGHT = WIDTH = 0;
+	tile = tileCols = 0;
+	rows = 0;
+	tileBytes = 0;
+	ok = false;
+}
+
+MazeTiledWriter::~MazeTiledWriter()
+{
+	if (fp)
+		fclose(fp);
+}
+
+bool MazeTiledWriter::open(const std::string& path, int height, int width, int tileSize, std::string* error)
+{
+	if (fp)
+		fclose(fp);
+	fp = nullptr;
+	if (height <= 0 || width <= 0)
+		return fail(error, "maze size must be positive");
+	fp = fopen(path.c_str(), "wb");
+	if (!fp)
+		return fail(error, "cannot create file");
+
+	HEIGHT = height;
+	WIDTH = width;
+	tile = roundTile(tileSize);
+	tileCols = (width + tile - 1) / tile;
+	tileBytes = (size_t)tile * tile / 2;
+	rows = 0;
+	band.assign(tileBytes * tileCols, 0);
+
+	MazeTiledHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAZE_TILED_MAGIC, 4);
+	header.version = MAZE_TILED_VERSION;
+	header.headerSize = MAZE_TILED_HEADER_BYTES;
+	header.height = height;
+	header.width = width;
+	header.tileSize = tile;
+	header.exitRow = height - 1;
+	header.exitCol = width - 1;
+	uint8_t bytes[MAZE_TILED_HEADER_BYTES];
+	mazeTiledEncodeHeader(header, bytes);
+	ok = fwrite(bytes, 1, sizeof(bytes), fp) == sizeof(bytes);
+	return ok || fail(error, "write failed");
+}
+
+bool MazeTiledWriter::writeRow(const uint8_t* walls)
+{
+	if (!fp || !ok || rows >= HEIGHT)
+		return false;
+	uint8_t* out = &band[(size_t)(rows & (tile - 1)) * (tile >> 1)];
+	for (int j = 0; j < WIDTH; j++) {
+		int c = j & (tile - 1);
+		out[(size_t)(j / tile) * tileBytes + (c >> 1)] |= (uint8_t)(walls[j] << ((c & 1) * 4));
+	}
+	rows++;
+	if ((rows & (tile - 1)) == 0 || rows == HEIGHT)
+		ok = flushBand();
+	return ok;
+}
+
+bool MazeTiledWriter::flushBand()
+{
+	bool written = fwrite(band.data(), 1, band.size(), fp) == band.size();
+	std::fill(band.begin(), band.end(), 0);
+	return written;
+}
+
+bool MazeTiledWriter::close(std::string* error)
+{
+	if (!fp)
+		return fail(error, "file is not open");
+	bool done = ok && rows == HEIGHT;
+	if (fclose(fp) != 0) done = false;
+	fp = nullptr;
+	std::vector<uint8_t>().swap(band);
+	return done || fail(error, ok ? "missing rows" : "write failed");
+}
+
+bool saveMazTiled(const MazeGrid& grid, const std::string& path, int tileSize, std::string* error)
+{
+	MazeTiledWriter writer;
+	if (!writer.open(path, grid.height(), grid.width(), tileSize, error))
+		return false;
+	std::vector<uint8_t> walls(grid.width());
+	for (int i = 0; i < grid.height(); i++) {
+		for (int j = 0; j < grid.width(); j++)
+			walls[j] = (uint8_t)grid.walls(i, j);
+		if (!writer.writeRow(walls.data()))
+			break;
+	}
+	return writer.close(error);
+}
+
+bool loadMazTiled(const std::string& path, MazeGrid& grid, std::string* error, MazeLoadProgress* progress)
+{
+	// Every tile is read once, in order, so there is nothing to prefetch
+	MazeTiledGrid tiled;
+	tiled.setPrefetch(false);
+	if (!tiled.open(path, 0, error)) {
+		grid.reset();
+		return false;
+	}
+
+	// Tile by tile, so each tile is read once
+	int H = tiled.height(), W = tiled.width(), T = tiled.tileSize();
+	// Tiles are all the same size, so progress goes by tiles read
+	uint64_t tileCount = (uint64_t)((H + T - 1) / T) * ((W + T - 1) / T), tilesRead = 0;
+	uint64_t total = tiled.fileBytes();
+	if (progress)
+		progress->bytesTotal.store(total, std::memory_order_relaxed);
+	grid.resize(H, W);
+	for (int r0 = 0; r0 < H; r0 += T) {
+		for (int c0 = 0; c0 < W; c0 += T) {
+			for (int i = r0; i < r0 + T && i < H; i++)
+				for (int j = c0; j < c0 + T && j < W; j++)
+					grid.setWalls(i, j, tiled.walls(i, j));
+			if (progress && !progress->update(total * ++tilesRead / tileCount)) {
+				grid.reset();
+				if (error) *error = "load cancelled";
+				return false;
+			}
+		}
+	}
+	grid.entranceRow = tiled.entranceRow;
+	grid.entranceCol = tiled.entranceCol;
+	grid.exitRow = tiled.exitRow;
+	grid.exitCol = tiled.exitCol;
+	return true;
+}
+
+//--------------------------------------------------------------
+MazeTiledGrid::MazeTiledGrid()
+{
+	HEIGHT = WIDTH = 0;
+	tile = 2;
+	shift = 1;
+	tileCols = tileRows = tileBytes = 0;
+	headerBytes = 0;
+	fp = nullptr;
+	prefetchFp = nullptr;
+	entranceRow = entranceCol = 0;
+	exitRow = exitCol = 0;
+	head = tail = -1;
+	current = SIZE_MAX;
+	currentData = nullptr;
+	hitCount = prefetchHitCount = missCount = 0;
+	prefetch = true;
+	quit = false;
+}
+
+MazeTiledGrid::~MazeTiledGrid()
+{
+	close();
+}
+
+bool MazeTiledGrid::open(const std::string& path, size_t cacheBytes, std::string* error)
+{
+	close();
+	fp = fopen(path.c_str(), "rb");
+	if (!fp)
+		return fail(error, "cannot open file");
+
+	uint8_t bytes[MAZE_TILED_HEADER_BYTES];
+	MazeTiledHeader header;
+	if (fread(bytes, 1, sizeof(bytes), fp) != sizeof(bytes) || memcmp(bytes, MAZE_TILED_MAGIC, 4) != 0) {
+		close();
+		return fail(error, "not a tiled maze file");
+	}
+	mazeTiledDecodeHeader(bytes, header);
+	if (header.version != MAZE_TILED_VERSION || header.headerSize < MAZE_TILED_HEADER_BYTES) {
+		close();
+		return fail(error, "unsupported tiled maze version");
+	}
+	if (header.height == 0 || header.width == 0 || header.height > INT_MAX || header.width > INT_MAX
+		|| header.tileSize < 2 || header.tileSize > (1 << 15) || (header.tileSize & (header.tileSize - 1))
+		|| header.entranceRow >= header.height || header.entranceCol >= header.width
+		|| header.exitRow >= header.height || header.exitCol >= header.width) {
+		close();
+		return fail(error, "bad tiled maze header");
+	}
+
+	HEIGHT = (int)header.height;
+	WIDTH = (int)header.width;
+	tile = (int)header.tileSize;
+	for (shift = 0; (1 << shift) < tile; shift++) {}
+	tileCols = (WIDTH + tile - 1) / tile;
+	tileRows = (HEIGHT + tile - 1) / tile;
+	tileBytes = (size_t)tile * tile / 2;
+	entranceRow = header.entranceRow;
+	entranceCol = header.entranceCol;
+	exitRow = header.exitRow;
+	exitCol = header.exitCol;
+	if (fileSize(fp) < header.headerSize + (uint64_t)tileCols * tileRows * tileBytes) {
+		close();
+		return fail(error, "tiled maze file is truncated");
+	}
+	headerBytes = header.headerSize;
+
+	size_t count = std::max<size_t>(4, cacheBytes / tileBytes);
+	count = std::min(count, tileCols * tileRows);
+	slots.assign(count, std::vector<uint8_t>(tileBytes));
+	slotTile.assign(count, SIZE_MAX);
+	slotOf.assign(tileCols * tileRows, -1);
+	prev.resize(count);
+	next.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		prev[i] = (int)i - 1;
+		next[i] = i + 1 < count ? (int)i + 1 : -1;
+	}
+	head = 0;
+	tail = (int)count - 1;
+	current = SIZE_MAX;
+	currentData = nullptr;
+	resetCounters();
+
+	filePath = path;
+	if (prefetch)
+		startPrefetch();
+	return true;
+}
+
+void MazeTiledGrid::close()
+{
+	stopPrefetch();
+	if (fp) fclose(fp);
+	fp = nullptr;
+	filePath.clear();
+	std::vector<std::vector<uint8_t> >().swap(slots);
+	std::vector<size_t>().swap(slotTile);
+	std::vector<int>().swap(slotOf);
+	prev.clear();
+	next.clear();
+	head = tail = -1;
+	current = SIZE_MAX;
+	currentData = nullptr;
+	HEIGHT = WIDTH = 0;
+	entranceRow = entranceCol = 0;
+	exitRow = exitCol = 0;
+}
+
+void MazeTiledGrid::setPrefetch(bool on)
+{
+	prefetch = on;
+	if (on && fp)
+		startPrefetch();
+	else if (!on)
+		stopPrefetch();
+}
+
+void MazeTiledGrid::startPrefetch()
+{
+	if (prefetchFp)
+		return;
+	// A second handle so the worker never moves the reader's file position
+	prefetchFp = fopen(filePath.c_str(), "rb");
+	if (!prefetchFp)
+		return;
+	staged.resize(8);
+	for (size_t i = 0; i < staged.size(); i++) {
+		staged[i].state = FREE;
+		staged[i].data.resize(tileBytes);
+	}
+	quit = false;
+	worker = std::thread(&MazeTiledGrid::prefetchWorker, this);
+}
+
+void MazeTiledGrid::stopPrefetch()
+{
+	if (worker.joinable()) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			quit = true;
+		}
+		wake.notify_all();
+		worker.join();
+	}
+	if (prefetchFp)
+		fclose(prefetchFp);
+	prefetchFp = nullptr;
+	std::vector<Staged>().swap(staged);
+}
+
+size_t MazeTiledGrid::memoryBytes() const
+{
+	return (slots.size() + staged.size()) * tileBytes
+		+ slotOf.capacity() * sizeof(int) + slotTile.capacity() * sizeof(size_t);
+}
+
+bool MazeTiledGrid::readTile(FILE* file, size_t t, uint8_t* out) const
+{
+	return seekTo(file, headerBytes + (uint64_t)t * tileBytes) && fread(out, 1, tileBytes, file) == tileBytes;
+}
+
+// Move a slot to the front of the LRU list
+void MazeTiledGrid::touch(int slot) const
+{
+	if (slot == head)
+		return;
+	next[prev[slot]] = next[slot];
+	if (next[slot] >= 0)
+		prev[next[slot]] = prev[slot];
+	else
+		tail = prev[slot];
+	prev[slot] = -1;
+	next[slot] = head;
+	prev[head] = slot;
+	head = slot;
+}
+
+void MazeTiledGrid::fetch(size_t t) const
+{
+	int slot = slotOf[t];
+	if (slot >= 0) {
+		hitCount++;
+	}
+	else {
+		// Reuse the least recently used slot
+		slot = tail;
+		if (slotTile[slot] != SIZE_MAX)
+			slotOf[slotTile[slot]] = -1;
+
+		bool ready = false;
+		if (prefetchFp) {
+			std::unique_lock<std::mutex> guard(lock);
+			for (size_t i = 0; i < staged.size(); i++) {
+				Staged& s = staged[i];
+				if (s.state == FREE || s.tile != t)
+					continue;
+				loaded.wait(guard, [&] { return s.state == READY; });
+				slots[slot].swap(s.data);
+				s.state = FREE;
+				ready = true;
+				break;
+			}
+		}
+		if (ready) {
+			prefetchHitCount++;
+		}
+		else {
+			missCount++;
+			// A read error leaves the tile walled in
+			if (!readTile(fp, t, slots[slot].data()))
+				std::fill(slots[slot].begin(), slots[slot].end(), 0xFF);
+		}
+		slotTile[slot] = t;
+		slotOf[t] = slot;
+		if (prefetch && prefetchFp)
+			requestNeighbours(t);
+	}
+	touch(slot);
+	current = t;
+	currentData = slots[slot].data();
+}
+
+void MazeTiledGrid::requestNeighbours(size_t t) const
+{
+	size_t row = t / tileCols, col = t % tileCols;
+	size_t around[4];
+	int n = 0;
+	if (row > 0) around[n++] = t - tileCols;
+	if (col + 1 < tileCols) around[n++] = t + 1;
+	if (row + 1 < tileRows) around[n++] = t + tileCols;
+	if (col > 0) around[n++] = t - 1;
+
+	bool queued = false;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		for (int k = 0; k < n; k++) {
+			size_t want = around[k];
+			if (slotOf[want] >= 0)
+				continue;
+			int free = -1, stale = -1;
+			bool known = false;
+			for (size_t i = 0; i < staged.size(); i++) {
+				if (staged[i].state == FREE) {
+					if (free < 0) free = (int)i;
+				}
+				else if (staged[i].tile == want) {
+					known = true;
+				}
+				else if (staged[i].state == READY && stale < 0) {
+					stale = (int)i;
+				}
+			}
+			if (known)
+				continue;
+			// Out of buffers: drop a guess that has not been used yet
+			int use = free >= 0 ? free : stale;
+			if (use < 0)
+				break;
+			staged[use].tile = want;
+			staged[use].state = QUEUED;
+			queued = true;
+		}
+	}
+	if (queued)
+		wake.notify_one();
+}
+
+void MazeTiledGrid::prefetchWorker()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	for (;;) {
+		Staged* job = nullptr;
+		wake.wait(guard, [&] {
+			if (quit)
+				return true;
+			for (size_t i = 0; i < staged.size() && !job; i++)
+				if (staged[i].state == QUEUED)
+					job = &staged[i];
+			return job != nullptr;
+		});
+		if (quit)
+			return;
+		job->state = LOADING;
+		size_t t = job->tile;
+		uint8_t* out = job->data.data();
+		guard.unlock();
+		if (!readTile(prefetchFp, t, out))
+			memset(out, 0xFF, tileBytes);
+		guard.lock();
+		job->state = READY;
+		loaded.notify_all();
+	}
+}
@@ -0,0 +1,190 @@
+/*
+
+	mazeTiledGrid.h
+
+	Out-of-core maze storage (.mazt) for mazes larger than memory.
+
+	The file is a 40 byte little-endian header followed by square tiles of tileSize x
+	tileSize cells, in row-major tile order. A tile holds the WALL_* flags
+	of its cells two per byte like .mazb, row by row, padded to full size
+	at the right and bottom edges, so tile t starts at a fixed offset.
+
+	MazeTiledGrid reads tiles on demand into a fixed number of cache slots
+	and evicts the least recently used one. After a miss a background
+	thread reads the four neighbouring tiles into a few staging buffers,
+	so a search walking off the edge of a tile usually finds the next one
+	ready. It has the same interface as MazeGrid for solvers, so the
+	template solvers run on it unchanged with memory bounded by the cache.
+
+	MazeTiledWriter makes the file from rows, holding one band of tiles.
+
+*/
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mazeGrid.h"
+
+struct MazeLoadProgress;
+
+#define MAZE_TILED_VERSION 1
+
+struct MazeTiledHeader {
+	char magic[4]; // "MAZT"
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t height;
+	uint32_t width;
+	uint32_t tileSize; // power of two, at least 2
+	uint32_t entranceRow, entranceCol;
+	uint32_t exitRow, exitCol;
+	uint32_t reserved;
+};
+
+// Size of the header in a file
+#define MAZE_TILED_HEADER_BYTES 40
+
+// True if the data starts with a tiled maze header
+bool isMazeTiled(const char* data, size_t size);
+
+// The header as stored in a file, field by field in little-endian order
+// whatever the byte order of the host
+void mazeTiledEncodeHeader(const MazeTiledHeader& header, uint8_t out[MAZE_TILED_HEADER_BYTES]);
+void mazeTiledDecodeHeader(const uint8_t in[MAZE_TILED_HEADER_BYTES], MazeTiledHeader& header);
+
+// Writes a .mazt file one row of cells at a time
+class MazeTiledWriter {
+
+public:
+
+	MazeTiledWriter();
+	~MazeTiledWriter();
+
+	// tileSize is rounded up to a power of two
+	bool open(const std::string& path, int height, int width, int tileSize = 256, std::string* error = nullptr);
+	// Append the WALL_* flags of the next row, width entries
+	bool writeRow(const uint8_t* walls);
+	// Write the last band. Fails if fewer than height rows were written.
+	bool close(std::string* error = nullptr);
+
+private:
+
+	bool flushBand();
+
+	FILE* fp;
+	int HEIGHT, WIDTH;
+	int tile, tileCols;
+	int rows; // rows written
+	size_t tileBytes;
+	std::vector<uint8_t> band; // one row of tiles
+	bool ok;
+
+};
+
+// Write grid as .mazt
+bool saveMazTiled(const MazeGrid& grid, const std::string& path, int tileSize = 256, std::string* error = nullptr);
+
+// Load a .mazt file into grid, reporting to progress (see mazeLoader.h)
+bool loadMazTiled(const std::string& path, MazeGrid& grid, std::string* error = nullptr,
+	MazeLoadProgress* progress = nullptr);
+
+class MazeTiledGrid {
+
+public:
+
+	MazeTiledGrid();
+	~MazeTiledGrid();
+
+	// Open a .mazt file with a cache of about cacheBytes (at least four
+	// tiles). Reads only the header. Starts the prefetch thread unless
+	// prefetching was turned off first.
+	bool open(const std::string& path, size_t cacheBytes = 64 << 20, std::string* error = nullptr);
+	void close();
+
+	bool empty() const { return HEIGHT == 0 || WIDTH == 0; }
+	int height() const { return HEIGHT; }
+	int width() const { return WIDTH; }
+	size_t cellCount() const { return (size_t)HEIGHT * WIDTH; }
+	size_t index(int row, int col) const { return (size_t)row * WIDTH + col; }
+
+	int walls(int row, int col) const {
+		size_t t = (size_t)(row >> shift) * tileCols + (col >> shift);
+		if (t != current)
+			fetch(t);
+		int r = row & (tile - 1), c = col & (tile - 1);
+		return (currentData[(size_t)r * (tile >> 1) + (c >> 1)] >> ((c & 1) * 4)) & 0xF;
+	}
+	bool canMove(int row, int col, int dir) const { return (walls(row, col) & mazeWallFlag(dir)) == 0; }
+
+	int entranceRow, entranceCol;
+	int exitRow, exitCol;
+
+	int tileSize() const { return tile; }
+	size_t cacheTiles() const { return slots.size(); }
+	// Size of the header and tiles in the file
+	uint64_t fileBytes() const { return headerBytes + (uint64_t)tileRows * tileCols * tileBytes; }
+
+	// Read neighbouring tiles in the background after a miss. On by
+	// default; the thread only runs while a file is open with it on.
+	void setPrefetch(bool on);
+
+	// Switches to another tile that found it cached, found it prefetched,
+	// or had to read it. Reset by open and resetCounters.
+	size_t hits() const { return hitCount; }
+	size_t prefetchHits() const { return prefetchHitCount; }
+	size_t misses() const { return missCount; }
+	void resetCounters() { hitCount = prefetchHitCount = missCount = 0; }
+
+	// Bytes held by the cache and staging buffers
+	size_t memoryBytes() const;
+
+private:
+
+	struct Staged {
+		size_t tile;
+		int state; // FREE, QUEUED, LOADING or READY
+		std::vector<uint8_t> data;
+	};
+	enum { FREE, QUEUED, LOADING, READY };
+
+	void fetch(size_t t) const;
+	void touch(int slot) const;
+	void requestNeighbours(size_t t) const;
+	void startPrefetch();
+	void stopPrefetch();
+	void prefetchWorker();
+	bool readTile(FILE* file, size_t t, uint8_t* out) const;
+
+	int HEIGHT, WIDTH;
+	int tile, shift;
+	size_t tileCols, tileRows, tileBytes;
+	uint64_t headerBytes;
+	std::string filePath;
+	FILE* fp;
+
+	// Cache, touched only by the thread that reads the grid
+	mutable std::vector<std::vector<uint8_t> > slots;
+	mutable std::vector<size_t> slotTile; // tile in each slot, SIZE_MAX when empty
+	mutable std::vector<int> slotOf; // slot of each tile, -1 when not cached
+	mutable std::vector<int> prev, next; // LRU list over slots, most recent first
+	mutable int head, tail;
+	mutable size_t current; // tile of the last access
+	mutable const uint8_t* currentData;
+	mutable size_t hitCount, prefetchHitCount, missCount;
+
+	// Prefetching, shared with the worker under lock
+	bool prefetch;
+	FILE* prefetchFp;
+	std::thread worker;
+	mutable std::mutex lock;
+	mutable std::condition_variable wake, loaded;
+	mutable std::vector<Staged> staged;
+	bool quit;
+
+};
@@ -0,0 +1,136 @@
+/*
+
+	mazeTreeOracle.cpp
+
+*/
+#include "mazeTreeOracle.h"
+
+MazeTreeOracle::MazeTreeOracle()
+{
+	cells = 0;
+	WIDTH = 0;
+	root = 0;
+}
+
+void MazeTreeOracle::clear()
+{
+	cells = 0;
+	WIDTH = 0;
+	std::vector<uint32_t>().swap(tin);
+	std::vector<uint32_t>().swap(order);
+	std::vector<uint32_t>().swap(masks);
+	std::vector<std::vector<uint32_t> >().swap(table);
+	parent.reset(0);
+}
+
+size_t MazeTreeOracle::memoryBytes() const
+{
+	size_t bytes = (tin.capacity() + order.capacity() + masks.capacity()) * sizeof(uint32_t) + parent.memoryBytes();
+	for (size_t k = 0; k < table.size(); k++)
+		bytes += table[k].capacity() * sizeof(uint32_t);
+	return bytes;
+}
+
+void MazeTreeOracle::buildRangeMin()
+{
+	size_t n = order.size();
+	masks.resize(n);
+	size_t blocks = (n + BLOCK - 1) / BLOCK;
+	table.assign(1, std::vector<uint32_t>(blocks));
+
+	// Keep a stack of increasing minima per block as a bit mask
+	uint32_t stack = 0;
+	for (size_t i = 0; i < n; i++) {
+		size_t at = i % BLOCK;
+		if (at == 0)
+			stack = 0;
+		size_t base = i - at;
+		while (stack && order[base + mazeHighBit(stack)] >= order[i])
+			stack &= ~(1U << mazeHighBit(stack));
+		stack |= 1U << at;
+		masks[i] = stack;
+		if (at == 0 || order[i] < table[0][i / BLOCK])
+			table[0][i / BLOCK] = order[i];
+	}
+
+	for (size_t k = 1; ((size_t)1 << k) <= blocks; k++) {
+		const std::vector<uint32_t>& below = table[k - 1];
+		std::vector<uint32_t> level(blocks - ((size_t)1 << k) + 1);
+		for (size_t b = 0; b < level.size(); b++) {
+			uint32_t x = below[b], y = below[b + ((size_t)1 << (k - 1))];
+			level[b] = x < y ? x : y;
+		}
+		table.push_back(level);
+	}
+}
+
+uint32_t MazeTreeOracle::rangeMin(uint32_t lo, uint32_t hi) const
+{
+	uint32_t lb = lo / BLOCK, hb = hi / BLOCK;
+	if (lb == hb)
+		return blockMin(lo, hi);
+
+	uint32_t best = blockMin(lo, lb * BLOCK + BLOCK - 1);
+	uint32_t right = blockMin(hb * BLOCK, hi);
+	if (right < best) best = right;
+	if (hb - lb > 1) {
+		uint32_t span = hb - lb - 1;
+		int k = mazeHighBit(span);
+		uint32_t x = table[k][lb + 1], y = table[k][hb - ((uint32_t)1 << k)];
+		if (x < best) best = x;
+		if (y < best) best = y;
+	}
+	return best;
+}
+
+void MazeTreeOracle::distances(const MazeCellPair* pairs, size_t count, uint32_t* out) const
+{
+	// Random cells miss the cache. Load the preorder positions of pairs
+	// 16 queries ahead, and the depths and masks they point at 8 ahead.
+	const size_t ahead = 16;
+	for (size_t i = 0; i < count; i++) {
+#if defined(__GNUC__) || defined(__clang__)
+		if (i + ahead < count) {
+			__builtin_prefetch(&tin[pairs[i + ahead].src]);
+			__builtin_prefetch(&tin[pairs[i + ahead].dst]);
+		}
+		if (i + ahead / 2 < count) {
+			uint32_t ta = tin[pairs[i + ahead / 2].src], tb = tin[pairs[i + ahead / 2].dst];
+			__builtin_prefetch(&order[ta]);
+			__builtin_prefetch(&order[tb]);
+			__builtin_prefetch(&masks[ta]);
+			__builtin_prefetch(&masks[tb]);
+		}
+#endif
+		out[i] = distance(pairs[i].src, pairs[i].dst);
+	}
+}
+
+void MazeTreeOracle::path(size_t a, size_t b, MazePath& path) const
+{
+	int ar = (int)(a / WIDTH), ac = (int)(a % WIDTH);
+	int br = (int)(b / WIDTH), bc = (int)(b % WIDTH);
+	path.reset(ar, ac);
+	if (!ready())
+		return;
+
+	// The distance gives the depth of the common ancestor, and so how far
+	// each cell climbs to reach it
+	uint32_t up = depthOf(a), down = depthOf(b);
+	uint32_t common = (up + down - distance(a, b)) / 2;
+	size_t stepsUp = up - common, stepsDown = down - common;
+	path.resize(stepsUp + stepsDown);
+
+	// a climbs toward the ancestor against each parent direction
+	for (size_t i = 0; i < stepsUp; i++) {
+		int dir = parent.get((size_t)ar * WIDTH + ac);
+		path.set(i, mazeOpposite(dir));
+		walkUp(ar, ac);
+	}
+	// b's climb, reversed, is the way down from the ancestor
+	for (size_t i = stepsUp + stepsDown; i > stepsUp; i--) {
+		int dir = parent.get((size_t)br * WIDTH + bc);
+		path.set(i - 1, dir);
+		walkUp(br, bc);
+	}
+}
@@ -0,0 +1,158 @@
+/*
+
+	mazeTreeOracle.h
+
+	Constant time distance queries on a perfect maze.
+
+	A perfect maze is a tree, so the path between two cells is unique and
+	its length is depth(a) + depth(b) - 2 depth(lca(a, b)). build() roots
+	the tree at the entrance and lists the cells in DFS preorder. For a
+	before b in that order, the depth of their lowest common ancestor is
+	one less than the smallest depth among the cells after a up to b, so
+	a distance query is one range minimum.
+
+	The range minimum uses blocks of 32 positions: a sparse table over the
+	block minima, and inside a block a 32-bit mask per position of the
+	increasing minima ending there, read with one count-trailing-zeros.
+	That is O(1) per query with about 12 bytes per cell, against the
+	n log n words of a plain sparse table.
+
+	Path queries walk both cells up to their common ancestor through the
+	two-bit parent directions, in O(path length).
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mazeBitset.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+struct MazeCellPair {
+	uint32_t src, dst; // cell indices, row * width + col
+};
+
+class MazeTreeOracle {
+
+public:
+
+	MazeTreeOracle();
+
+	// Preprocess a perfect maze. Fails if the maze has a loop, has a part
+	// that cannot be reached, or has 2^32 cells or more.
+	template <class Grid>
+	bool build(const Grid& grid, std::string* error = nullptr);
+	void clear();
+
+	bool ready() const { return cells > 0; }
+
+	// Steps between two cells, by cell index
+	uint32_t distance(size_t a, size_t b) const {
+		uint32_t ta = tin[a], tb = tin[b];
+		if (ta == tb)
+			return 0;
+		if (ta > tb) { uint32_t t = ta; ta = tb; tb = t; }
+		return order[ta] + order[tb] - 2 * (rangeMin(ta + 1, tb) - 1);
+	}
+
+	// Distances of count pairs into out
+	void distances(const MazeCellPair* pairs, size_t count, uint32_t* out) const;
+
+	// Fill path with the steps from cell a to cell b
+	void path(size_t a, size_t b, MazePath& path) const;
+
+	size_t memoryBytes() const;
+
+private:
+
+	enum { BLOCK = 32 };
+
+	uint32_t depthOf(size_t cell) const { return order[tin[cell]]; }
+	uint32_t rangeMin(uint32_t lo, uint32_t hi) const;
+	uint32_t blockMin(uint32_t lo, uint32_t hi) const {
+		uint32_t m = masks[hi] & (~0U << (lo % BLOCK));
+		return order[hi - hi % BLOCK + mazeLowBit(m)];
+	}
+	void buildRangeMin();
+	void walkUp(int& row, int& col) const {
+		int dir = parent.get((size_t)row * WIDTH + col);
+		row -= MAZE_DROW[dir];
+		col -= MAZE_DCOL[dir];
+	}
+
+	size_t cells;
+	int WIDTH;
+	uint32_t root;
+	std::vector<uint32_t> tin; // preorder position of each cell
+	std::vector<uint32_t> order; // depth of the cell at each preorder position
+	std::vector<uint32_t> masks; // in-block minima masks, one per position
+	std::vector<std::vector<uint32_t> > table; // sparse table over block minima
+	MazeDirArray parent; // direction each cell was entered by from the root
+
+};
+
+template <class Grid>
+bool MazeTreeOracle::build(const Grid& grid, std::string* error)
+{
+	clear();
+	if (grid.empty() || grid.cellCount() >= UINT32_MAX) {
+		if (error) *error = grid.empty() ? "maze is empty" : "maze is too large";
+		return false;
+	}
+	int H = grid.height();
+	int W = grid.width();
+	size_t n = grid.cellCount();
+	tin.assign(n, UINT32_MAX);
+	order.resize(n);
+	parent.reset(n);
+	WIDTH = W;
+	root = (uint32_t)grid.index(grid.entranceRow, grid.entranceCol);
+
+	// Iterative preorder. A stack entry is depth << 32 | cell; children are
+	// pushed when their parent is numbered, so every subtree is contiguous.
+	std::vector<uint64_t> stack;
+	stack.push_back(root);
+	uint32_t next = 0;
+	bool loop = false;
+	while (!stack.empty() && !loop) {
+		uint64_t top = stack.back();
+		stack.pop_back();
+		size_t cur = (size_t)(uint32_t)top;
+		uint32_t depth = (uint32_t)(top >> 32);
+		tin[cur] = next;
+		order[next++] = depth;
+
+		int row = (int)(cur / W);
+		int col = (int)(cur % W);
+		int back = cur == root ? -1 : mazeOpposite(parent.get(cur));
+		for (int dir = 0; dir < 4; dir++) {
+			if (dir == back || !grid.canMove(row, col, dir))
+				continue;
+			int nr = row + MAZE_DROW[dir];
+			int nc = col + MAZE_DCOL[dir];
+			if (nr < 0 || nr >= H || nc < 0 || nc >= W)
+				continue;
+			size_t child = grid.index(nr, nc);
+			// In a tree only the parent is already known
+			if (tin[child] != UINT32_MAX) {
+				loop = true;
+				break;
+			}
+			tin[child] = UINT32_MAX - 1;
+			parent.set(child, dir);
+			stack.push_back((uint64_t)(depth + 1) << 32 | child);
+		}
+	}
+	if (loop || next != n) {
+		if (error) *error = loop ? "maze has a loop" : "maze has unreachable cells";
+		clear();
+		return false;
+	}
+
+	cells = n;
+	buildRangeMin();
+	return true;
+}
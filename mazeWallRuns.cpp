@@ -0,0 +1,88 @@
+/*
+
+	mazeWallRuns.cpp
+
+*/
+#include "mazeWallRuns.h"
+#include "mazeBitset.h"
+
+// First bit at or after from that is set (or clear), or n if there is none
+static int nextBit(const uint64_t* bits, int n, int from, bool set)
+{
+	int words = (n + 63) >> 6;
+	int w = from >> 6;
+	uint64_t word = (set ? bits[w] : ~bits[w]) & (~0ULL << (from & 63));
+	while (!word) {
+		if (++w >= words)
+			return n;
+		word = set ? bits[w] : ~bits[w];
+	}
+	int at = (w << 6) + mazeLowBit64(word);
+	return at < n ? at : n;
+}
+
+// Bits of word w that fall in columns [from, to]
+static uint64_t windowMask(size_t w, int from, int to)
+{
+	int lo = (int)(w << 6), hi = lo + 63;
+	uint64_t mask = ~0ULL;
+	if (from > lo)
+		mask &= ~0ULL << (from - lo);
+	if (to < hi)
+		mask &= ~0ULL >> (hi - to);
+	return mask;
+}
+
+void mazeWallRuns(const MazeGrid& grid, std::vector<MazeWallRun>& runs)
+{
+	mazeWallRuns(grid, 0, 0, grid.height(), grid.width(), runs);
+}
+
+void mazeWallRuns(const MazeGrid& grid, int row0, int col0, int row1, int col1, std::vector<MazeWallRun>& runs)
+{
+	runs.clear();
+	int H = grid.height();
+	int W = grid.width();
+	if (grid.empty() || row0 >= row1 || col0 >= col1)
+		return;
+	// Wall lines owned by the window, inclusive
+	int lastRow = row1 == H ? H : row1 - 1;
+	int lastCol = col1 == W ? W : col1 - 1;
+
+	// Horizontal walls: runs along each wall row
+	for (int r = row0; r <= lastRow; r++) {
+		const uint64_t* bits = grid.hRow(r);
+		for (int c = nextBit(bits, col1, col0, true); c < col1; ) {
+			int end = nextBit(bits, col1, c, false);
+			MazeWallRun run = { r, c, end, false };
+			runs.push_back(run);
+			c = end < col1 ? nextBit(bits, col1, end, true) : col1;
+		}
+	}
+
+	// Vertical walls: a run starts where a wall column's bit turns on from
+	// one row to the next and ends where it turns off, so only the bits that
+	// differ between consecutive rows are visited
+	size_t w0 = (size_t)col0 >> 6, w1 = (size_t)lastCol >> 6;
+	std::vector<int> open(lastCol - col0 + 1, -1);
+	std::vector<uint64_t> none(w1 + 1, 0);
+	const uint64_t* prev = none.data();
+	for (int r = row0; r <= row1; r++) {
+		const uint64_t* cur = r < row1 ? grid.vRow(r) : none.data();
+		for (size_t w = w0; w <= w1; w++) {
+			uint64_t diff = (cur[w] ^ prev[w]) & windowMask(w, col0, lastCol);
+			while (diff) {
+				int b = mazeLowBit64(diff);
+				diff &= diff - 1;
+				int c = (int)(w << 6) + b;
+				if ((cur[w] >> b) & 1)
+					open[c - col0] = r;
+				else {
+					MazeWallRun run = { c, open[c - col0], r, true };
+					runs.push_back(run);
+				}
+			}
+		}
+		prev = cur;
+	}
+}
@@ -0,0 +1,34 @@
+/*
+
+	mazeWallRuns.h
+
+	The walls of a maze as straight runs, for drawing.
+
+	Walls live in two bitplanes with one bit per wall, so a wall shared by
+	two cells appears once. Runs of consecutive set bits along a line of
+	the horizontal plane, and down a column of the vertical plane, become
+	one run each, found a word at a time. A perfect maze of n cells has
+	about n walls but far fewer runs, so a renderer draws one quad per run
+	instead of up to four lines per cell.
+
+*/
+#pragma once
+
+#include <vector>
+#include "mazeGrid.h"
+
+struct MazeWallRun {
+	int line; // wall row (0..height) of a horizontal run, wall column (0..width) of a vertical one
+	int from, to; // cells covered along the line, to exclusive
+	bool vertical;
+};
+
+// Every wall of grid as maximal runs, horizontal runs first
+void mazeWallRuns(const MazeGrid& grid, std::vector<MazeWallRun>& runs);
+
+// The walls of the cells in rows [row0, row1) and columns [col0, col1)
+// that lie on their top or left side, and on their bottom or right side
+// at the last row or column of the grid. Runs are cut at the window's
+// edges. Cutting the grid into tiles this way gives every wall to exactly
+// one tile.
+void mazeWallRuns(const MazeGrid& grid, int row0, int col0, int row1, int col1, std::vector<MazeWallRun>& runs);
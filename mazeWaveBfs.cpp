@@ -0,0 +1,330 @@
+/*
+
+	mazeWaveBfs.cpp
+
+*/
+#include "mazeWaveBfs.h"
+#include "mazeBitset.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#if defined(__GNUC__) || defined(__clang__)
+#define MAZE_WAVE_AVX2 1
+#define MAZE_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(__AVX2__)
+#define MAZE_WAVE_AVX2 1
+#define MAZE_AVX2_TARGET
+#endif
+#endif
+
+#ifdef MAZE_WAVE_AVX2
+#include <immintrin.h>
+#endif
+
+// Rows needed to expand one row of the frontier
+struct MazeWaveRow {
+	const uint64_t* up; // frontier, row above
+	const uint64_t* mid; // frontier, this row
+	const uint64_t* down; // frontier, row below
+	const uint64_t* hTop; // walls above this row
+	const uint64_t* hBottom; // walls below this row
+	const uint64_t* v; // walls left of each cell of this row
+	uint64_t* mark0;
+	uint64_t* mark1;
+	uint64_t* out; // next frontier
+	int words;
+	int vWords;
+	uint64_t lastMask;
+	uint64_t code0, code1; // all ones where the level code has the bit
+};
+
+// Frontier cells of word w that can step right / left
+static inline uint64_t movesRight(const MazeWaveRow& x, int w)
+{
+	if (w < 0 || w >= x.words) return 0;
+	uint64_t wall = (x.v[w] >> 1) | (w + 1 < x.vWords ? x.v[w + 1] << 63 : 0);
+	return x.mid[w] & ~wall;
+}
+
+static inline uint64_t movesLeft(const MazeWaveRow& x, int w)
+{
+	if (w < 0 || w >= x.words) return 0;
+	return x.mid[w] & ~x.v[w];
+}
+
+static inline void storeWord(const MazeWaveRow& x, int w, uint64_t n)
+{
+	x.out[w] = n;
+	x.mark0[w] |= n & x.code0;
+	x.mark1[w] |= n & x.code1;
+}
+
+// Expand words w0..w1 of a row, widening [lo, hi] to the words that
+// received new cells
+static void expandScalar(const MazeWaveRow& x, int w0, int w1, int& lo, int& hi)
+{
+	// Horizontal moves out of the neighbouring words, carried along the row
+	uint64_t rightPrev = movesRight(x, w0 - 1);
+	uint64_t leftCur = movesLeft(x, w0);
+	for (int w = w0; w <= w1; w++) {
+		uint64_t rightCur = movesRight(x, w);
+		uint64_t leftNext = movesLeft(x, w + 1);
+		uint64_t n = (x.up[w] & ~x.hTop[w]) | (x.down[w] & ~x.hBottom[w])
+			| (rightCur << 1) | (rightPrev >> 63) | (leftCur >> 1) | (leftNext << 63);
+		rightPrev = rightCur;
+		leftCur = leftNext;
+
+		n &= ~(x.mark0[w] | x.mark1[w]);
+		if (w == x.words - 1) n &= x.lastMask;
+		if (!n) continue;
+
+		storeWord(x, w, n);
+		if (lo > w) lo = w;
+		hi = w;
+	}
+}
+
+#ifdef MAZE_WAVE_AVX2
+
+MAZE_AVX2_TARGET
+static void expandAvx2(const MazeWaveRow& x, int w0, int w1, int& lo, int& hi)
+{
+	int w = w0;
+	// Blocks of four words, staying clear of the masked last word
+	for (; w + 3 <= w1 && w + 4 < x.words; w += 4) {
+		__m256i up = _mm256_loadu_si256((const __m256i*)(x.up + w));
+		__m256i down = _mm256_loadu_si256((const __m256i*)(x.down + w));
+		__m256i hTop = _mm256_loadu_si256((const __m256i*)(x.hTop + w));
+		__m256i hBottom = _mm256_loadu_si256((const __m256i*)(x.hBottom + w));
+		__m256i mid = _mm256_loadu_si256((const __m256i*)(x.mid + w));
+		__m256i v0 = _mm256_loadu_si256((const __m256i*)(x.v + w));
+		__m256i v1 = _mm256_loadu_si256((const __m256i*)(x.v + w + 1));
+		__m256i m0 = _mm256_loadu_si256((const __m256i*)(x.mark0 + w));
+		__m256i m1 = _mm256_loadu_si256((const __m256i*)(x.mark1 + w));
+
+		__m256i vert = _mm256_or_si256(_mm256_andnot_si256(hTop, up), _mm256_andnot_si256(hBottom, down));
+
+		// Step right: shift the 256-bit block left by one, carrying in
+		// the top bit of the previous word
+		__m256i rightWall = _mm256_or_si256(_mm256_srli_epi64(v0, 1), _mm256_slli_epi64(v1, 63));
+		__m256i right = _mm256_andnot_si256(rightWall, mid);
+		__m256i carry = _mm256_permute4x64_epi64(_mm256_srli_epi64(right, 63), _MM_SHUFFLE(2, 1, 0, 3));
+		carry = _mm256_blend_epi32(carry, _mm256_set_epi64x(0, 0, 0, (long long)(movesRight(x, w - 1) >> 63)), 0x03);
+		__m256i moved = _mm256_or_si256(_mm256_slli_epi64(right, 1), carry);
+
+		// Step left: shift right by one, carrying in the low bit of the next word
+		__m256i left = _mm256_andnot_si256(v0, mid);
+		carry = _mm256_permute4x64_epi64(_mm256_slli_epi64(left, 63), _MM_SHUFFLE(0, 3, 2, 1));
+		carry = _mm256_blend_epi32(carry, _mm256_set_epi64x((long long)(movesLeft(x, w + 4) << 63), 0, 0, 0), 0xC0);
+		moved = _mm256_or_si256(moved, _mm256_or_si256(_mm256_srli_epi64(left, 1), carry));
+
+		__m256i n = _mm256_andnot_si256(_mm256_or_si256(m0, m1), _mm256_or_si256(vert, moved));
+		if (_mm256_testz_si256(n, n))
+			continue;
+
+		_mm256_storeu_si256((__m256i*)(x.out + w), n);
+		_mm256_storeu_si256((__m256i*)(x.mark0 + w), _mm256_or_si256(m0, _mm256_and_si256(n, _mm256_set1_epi64x((long long)x.code0))));
+		_mm256_storeu_si256((__m256i*)(x.mark1 + w), _mm256_or_si256(m1, _mm256_and_si256(n, _mm256_set1_epi64x((long long)x.code1))));
+		if (lo > w) lo = w;
+		hi = w + 3;
+	}
+	expandScalar(x, w, w1, lo, hi);
+}
+
+#endif
+
+//--------------------------------------------------------------
+MazeWaveBfs::MazeWaveBfs()
+{
+	useSimd = true;
+	usedSimd = false;
+	expanded = 0;
+	levels = 0;
+	words = 0;
+}
+
+bool MazeWaveBfs::simdAvailable()
+{
+#if defined(MAZE_WAVE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+	return __builtin_cpu_supports("avx2") != 0;
+#elif defined(MAZE_WAVE_AVX2)
+	return true;
+#else
+	return false;
+#endif
+}
+
+size_t MazeWaveBfs::memoryBytes() const
+{
+	return (frontier.capacity() + next.capacity() + mark0.capacity() + mark1.capacity()) * sizeof(uint64_t)
+		+ (frontierLo.capacity() + frontierHi.capacity() + nextLo.capacity() + nextHi.capacity()) * sizeof(int);
+}
+
+void MazeWaveBfs::countReached()
+{
+	expanded = 0;
+	for (size_t i = 0; i < mark0.size(); i++)
+		expanded += mazePopcount(mark0[i] | mark1[i]);
+}
+
+int MazeWaveBfs::levelCode(int row, int col) const
+{
+	size_t w = (size_t)row * words + (col >> 6);
+	int b = col & 63;
+	return (int)((mark0[w] >> b) & 1) | (int)(((mark1[w] >> b) & 1) << 1);
+}
+
+bool MazeWaveBfs::solve(const MazeGrid& grid, MazePath& path)
+{
+	expanded = 0;
+	levels = 0;
+	usedSimd = false;
+	path.reset(grid.entranceRow, grid.entranceCol);
+	if (grid.empty())
+		return false;
+
+	int H = grid.height();
+	words = grid.rowWords();
+	size_t planeWords = (size_t)H * words;
+	// The frontier planes and spans have an empty guard row above and
+	// below, so frontier row r lives at row r + 1
+	frontier.assign(planeWords + 2 * words, 0);
+	next.assign(planeWords + 2 * words, 0);
+	mark0.assign(planeWords, 0);
+	mark1.assign(planeWords, 0);
+	frontierLo.assign(H + 2, words);
+	frontierHi.assign(H + 2, -1);
+	nextLo.assign(H + 2, words);
+	nextHi.assign(H + 2, -1);
+	activeRows.clear();
+	nextRows.clear();
+
+	// Level 0 is the entrance, level code 1
+	int sr = grid.entranceRow, sc = grid.entranceCol;
+	frontier[(size_t)(sr + 1) * words + (sc >> 6)] |= 1ULL << (sc & 63);
+	mark0[(size_t)sr * words + (sc >> 6)] |= 1ULL << (sc & 63);
+	frontierLo[sr + 1] = frontierHi[sr + 1] = sc >> 6;
+	activeRows.push_back(sr);
+	expanded = 1;
+	if (sr == grid.exitRow && sc == grid.exitCol)
+		return true;
+
+	bool simd = useSimd && simdAvailable();
+	usedSimd = simd;
+	size_t goalWord = (size_t)(grid.exitRow + 1) * words + (grid.exitCol >> 6);
+	uint64_t goalBit = 1ULL << (grid.exitCol & 63);
+
+	MazeWaveRow x;
+	x.words = words;
+	x.vWords = (int)grid.vRowWords();
+	x.lastMask = grid.lastWordMask();
+
+	for (size_t d = 1; !activeRows.empty(); d++) {
+		if (cancel.now())
+			return false;
+		int code = (int)(d % 3) + 1;
+		x.code0 = (code & 1) ? ~0ULL : 0;
+		x.code1 = (code & 2) ? ~0ULL : 0;
+		nextRows.clear();
+
+		// Candidate rows are the frontier rows and their neighbours, in order
+		int lastRow = -2;
+		for (size_t a = 0; a < activeRows.size(); a++) {
+			for (int r = activeRows[a] - 1; r <= activeRows[a] + 1; r++) {
+				if (r < 0 || r >= H || r <= lastRow)
+					continue;
+				lastRow = r;
+
+				// Span of the frontier words that can reach this row. Empty
+				// spans are (words, -1) so they drop out of min and max.
+				int w0 = std::min(std::min(frontierLo[r], frontierLo[r + 1]), frontierLo[r + 2]);
+				int w1 = std::max(std::max(frontierHi[r], frontierHi[r + 1]), frontierHi[r + 2]);
+				if (w0 > w1)
+					continue;
+
+				const uint64_t* rows = &frontier[(size_t)r * words];
+				x.up = rows;
+				x.mid = rows + words;
+				x.down = rows + 2 * words;
+				x.hTop = grid.hRow(r);
+				x.hBottom = grid.hRow(r + 1);
+				x.v = grid.vRow(r);
+				x.mark0 = &mark0[(size_t)r * words];
+				x.mark1 = &mark1[(size_t)r * words];
+				x.out = &next[(size_t)(r + 1) * words];
+
+				// Widen by a word where a horizontal move carries across the
+				// edge of this row's frontier span
+				int flo = frontierLo[r + 1], fhi = frontierHi[r + 1];
+				if (flo <= fhi) {
+					if (flo > 0 && (movesLeft(x, flo) & 1))
+						w0 = std::min(w0, flo - 1);
+					if (fhi + 1 < words && (movesRight(x, fhi) >> 63))
+						w1 = std::max(w1, fhi + 1);
+				}
+
+				int lo = words, hi = -1;
+#ifdef MAZE_WAVE_AVX2
+				if (simd) expandAvx2(x, w0, w1, lo, hi);
+				else expandScalar(x, w0, w1, lo, hi);
+#else
+				expandScalar(x, w0, w1, lo, hi);
+#endif
+				if (lo <= hi) {
+					nextLo[r + 1] = lo;
+					nextHi[r + 1] = hi;
+					nextRows.push_back(r);
+				}
+			}
+		}
+
+		// Clear the old frontier so it can be reused as the next one
+		for (size_t a = 0; a < activeRows.size(); a++) {
+			int r = activeRows[a] + 1;
+			uint64_t* row = &frontier[(size_t)r * words];
+			for (int w = frontierLo[r]; w <= frontierHi[r]; w++)
+				row[w] = 0;
+			frontierLo[r] = words;
+			frontierHi[r] = -1;
+		}
+		frontier.swap(next);
+		frontierLo.swap(nextLo);
+		frontierHi.swap(nextHi);
+		activeRows.swap(nextRows);
+		levels = d;
+
+		if (frontier[goalWord] & goalBit) {
+			countReached();
+			backtrack(grid, d, path);
+			return true;
+		}
+	}
+	countReached();
+	return false;
+}
+
+// Walk from the exit to the entrance, each step to an open neighbour one
+// level closer
+void MazeWaveBfs::backtrack(const MazeGrid& grid, size_t distance, MazePath& path) const
+{
+	int H = grid.height();
+	int W = grid.width();
+	int row = grid.exitRow;
+	int col = grid.exitCol;
+	path.resize(distance);
+	for (size_t k = distance; k > 0; k--) {
+		int want = (int)((k - 1) % 3) + 1;
+		for (int dir = 0; dir < 4; dir++) {
+			int pr = row - MAZE_DROW[dir];
+			int pc = col - MAZE_DCOL[dir];
+			if (pr < 0 || pr >= H || pc < 0 || pc >= W)
+				continue;
+			if (!grid.canMove(row, col, mazeOpposite(dir)) || levelCode(pr, pc) != want)
+				continue;
+			path.set(k - 1, dir);
+			row = pr;
+			col = pc;
+			break;
+		}
+	}
+}
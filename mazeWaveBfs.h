@@ -0,0 +1,70 @@
+/*
+
+	mazeWaveBfs.h
+
+	Bit-parallel breadth-first search on the wall bitplanes of a MazeGrid.
+
+	The frontier is a bitplane. Each level expands it 64 cells per word:
+	shift left/right within a row against the vertical walls, and move
+	up/down between rows against the horizontal walls. Only rows next to
+	the current frontier, and only the word span it covers, are visited.
+	Rows are processed four words at a time with AVX2 when the CPU has it.
+
+	Instead of parents every reached cell stores (distance mod 3) + 1 in two
+	bitplanes. That marks it visited, and walking back from the exit to any
+	open neighbour one level lower rebuilds a shortest path.
+
+	Best on open or looped mazes where frontiers are wide; on narrow perfect
+	mazes the queue-based MazeBfs touches fewer words.
+
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mazeCancel.h"
+#include "mazeGrid.h"
+#include "mazePath.h"
+
+class MazeWaveBfs {
+
+public:
+
+	MazeWaveBfs();
+
+	// Find a shortest path from the entrance to the exit. Returns false if
+	// there is none, in which case path is left empty.
+	bool solve(const MazeGrid& grid, MazePath& path);
+
+	// Use AVX2 when the CPU supports it. Clear to force the scalar kernel.
+	bool useSimd;
+	// True if the last solve ran the AVX2 kernel
+	bool usedSimd;
+
+	// Cells reached and levels expanded by the last solve
+	size_t expanded;
+	size_t levels;
+
+	// Checked between levels; solve stops early when it is set
+	MazeCancel cancel;
+
+	size_t memoryBytes() const;
+
+	// True if this build and CPU can run the AVX2 kernel
+	static bool simdAvailable();
+
+private:
+
+	void backtrack(const MazeGrid& grid, size_t distance, MazePath& path) const;
+	int levelCode(int row, int col) const;
+	void countReached();
+
+	int words; // words per row
+	std::vector<uint64_t> frontier, next; // bitplanes with a guard row at each end
+	std::vector<uint64_t> mark0, mark1; // (distance mod 3) + 1, bit 0 and bit 1
+	std::vector<int> frontierLo, frontierHi; // word span per frontier row, (words, -1) when empty
+	std::vector<int> nextLo, nextHi;
+	std::vector<int> activeRows, nextRows;
+
+};
@@ -30,19 +30,64 @@
 
 */
 #include "ofApp.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 using namespace std;
+
+// Ÿ   ĭ , ̺ ۰ ϸ ؽó ׸ (ĭ ȼ), Ȯ 
+static const int TILE = 64;
+static const float LOD_ZOOM = 6;
+static const float MIN_ZOOM = 0.05f;
+static const float MAX_ZOOM = 120;
+// Ӹ  Ÿ    ð, ޽ÿ ؽó   Ÿ ִ 
+static const uint64_t BUILD_BUDGET_US = 4000;
+static const size_t MAX_MESH_TILES = 512;
+static const size_t MAX_TEXTURE_TILES = 4096;
+// Ӹ Ž  ð, ð Ȯϴ ܰ , Ž ǥ ޽ ϳ  ĭ 
+static const uint64_t WATCH_BUDGET_US = 4000;
+static const size_t WATCH_BATCH = 256;
+static const size_t WATCH_CHUNK = 4096;
+//  ð, Ӹ ׸ ȣ ,  ׸ Ÿ   ɸ ð (ũ)
+static MazeMetric metricFrameUs("frame.us");
+static MazeMetric metricDrawCalls("draw.calls");
+static MazeMetric metricWallsUs("draw.walls.us");
+static MazeMetric metricTileMeshUs("tile.mesh.us");
+static MazeMetric metricTileTextureUs("tile.texture.us");
 //--------------------------------------------------------------
 void ofApp::setup() {
 
 	ofSetWindowTitle("Maze Example"); // Set the app name on the title bar
-	ofSetFrameRate(15);
+	ofSetFrameRate(60);
 	ofBackground(255, 255, 255);
 	// Get the window size for image loading
 	windowWidth = ofGetWidth();
 	windowHeight = ofGetHeight();
 	isdfs = false;
+	isBFS = 0;
+	dfs.reset(createMazeSolver("dfs"));
+	bfs.reset(createMazeSolver("bfs"));
+	pbfs.reset(createMazeSolver("pbfs"));
+	astar.reset(createMazeSolver("astar"));
+	jps.reset(createMazeSolver("jps"));
+	bibfs.reset(createMazeSolver("bibfs"));
+	biastar.reset(createMazeSolver("biastar"));
+	lpaSeed.reset(createLpaSolver(lpa));
 	isOpen = 0;
+	zoom = 30;
+	panX = panY = 0;
+	dragX = dragY = 0;
+	viewWidth = ofGetWidth();
+	viewHeight = ofGetHeight();
+	tileRows = tileCols = 0;
+	meshTiles = textureTiles = 0;
+	frameCount = 0;
+	visibleTiles = 0;
+	visibleRuns = 0;
+	drawCalls = 0;
+	watchQuads = 0;
+	watchSpeed = 64;
+	watchUs = 0;
 	// Centre on the screen
 	ofSetWindowPosition((ofGetScreenWidth() - windowWidth) / 2, (ofGetScreenHeight() - windowHeight) / 2);
 
@@ -84,6 +129,8 @@ void ofApp::setup() {
 
 	// Open an maze file
 	menu->AddPopupItem(hPopup, "Open", false, false); // Not checked and not auto-checked
+	// ݱ  ð Ƚ JSON Ǵ CSV Ϸ 
+	menu->AddPopupItem(hPopup, "Save metrics", false, false); // Not checked and not auto-checked
 
 	// Final File popup menu item is "Exit" - add a separator before it
 	menu->AddPopupSeparator(hPopup);
@@ -97,7 +144,16 @@ void ofApp::setup() {
 	bShowInfo = true;  // screen info display on
 	menu->AddPopupItem(hPopup, "Show DFS", false, false); // Checked
 	bTopmost = false; // app is topmost
-	menu->AddPopupItem(hPopup, "Show BFS"); // Not checked (default)
+	menu->AddPopupItem(hPopup, "Show BFS", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Show parallel BFS", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Show A*", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Show JPS", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Show bidirectional BFS", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Show bidirectional A*", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Watch DFS", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Watch BFS", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Watch A*", false, false); // Not checked and not auto-checked
+	menu->AddPopupItem(hPopup, "Cancel search", false, false); // Not checked and not auto-checked
 	bFullscreen = false; // not fullscreen yet
 	menu->AddPopupItem(hPopup, "Full screen", false, false); // Not checked and not auto-check
 
@@ -131,6 +187,11 @@ void ofApp::appMenuFunction(string title, bool bChecked) {
 	if (title == "Open") {
 		readFile();
 	}
+	if (title == "Save metrics") {
+		ofFileDialogResult saveResult = ofSystemSaveDialog("metrics.json", "Save metrics (.json or .csv)");
+		if (saveResult.bSuccess)
+			saveMetrics(saveResult.getPath());
+	}
 	if (title == "Exit") {
 		ofExit(); // Quit the application
 	}
@@ -151,8 +212,58 @@ void ofApp::appMenuFunction(string title, bool bChecked) {
 	}
 
 	if (title == "Show BFS") {
-		doTopmost(bChecked); // Use the checked value directly
+		if (isOpen)
+			BFS();
+		else
+			cout << "you must open file first" << endl;
+	}
+
+	if (title == "Show parallel BFS") {
+		if (isOpen)
+			shortestPath(*pbfs);
+		else
+			cout << "you must open file first" << endl;
+	}
+
+	if (title == "Show A*") {
+		if (isOpen)
+			shortestPath(*astar);
+		else
+			cout << "you must open file first" << endl;
+	}
+
+	if (title == "Show JPS") {
+		if (isOpen)
+			shortestPath(*jps);
+		else
+			cout << "you must open file first" << endl;
+	}
+
+	if (title == "Show bidirectional BFS") {
+		if (isOpen)
+			shortestPath(*bibfs);
+		else
+			cout << "you must open file first" << endl;
+	}
+
+	if (title == "Show bidirectional A*") {
+		if (isOpen)
+			shortestPath(*biastar);
+		else
+			cout << "you must open file first" << endl;
+	}
+
+	if (title == "Watch DFS" || title == "Watch BFS" || title == "Watch A*") {
+		if (isOpen)
+			startWatch(title == "Watch DFS" ? MazeStepSearch::DFS
+				: title == "Watch BFS" ? MazeStepSearch::BFS : MazeStepSearch::ASTAR);
+		else
+			cout << "you must open file first" << endl;
+	}
 
+	if (title == "Cancel search") {
+		solveWorker.cancel();
+		stopWatch();
 	}
 
 	if (title == "Full screen") {
@@ -172,7 +283,50 @@ void ofApp::appMenuFunction(string title, bool bChecked) {
 
 //--------------------------------------------------------------
 void ofApp::update() {
-
+	// ۾ 尡   о  ̷η ٲ۴
+	if (loadWorker.finished())
+		finishLoad();
+
+	// ۾  Ž  θ Ѱܹ޴´
+	if (solveWorker.finished())
+		finishSolve();
+
+	//  ִ Ž Ӹ watchSpeed ܰ,  ð ȿ Ѵ
+	if (!isOpen || !watch.running())
+		return;
+	uint64_t t0 = ofGetElapsedTimeMicros();
+	size_t left = watchSpeed;
+	while (left > 0 && watch.running() && ofGetElapsedTimeMicros() - t0 < WATCH_BUDGET_US) {
+		size_t n = std::min(left, WATCH_BATCH);
+		watch.step(maze, n);
+		left -= n;
+	}
+	watchUs += ofGetElapsedTimeMicros() - t0;
+	appendWatchCells();
+	if (!watch.done())
+		return;
+
+	//  ã θ DFS Ǵ ִ  ڸ ־ ׸ Ѵ
+	const char* name = watch.searchKind() == MazeStepSearch::DFS ? "dfs"
+		: watch.searchKind() == MazeStepSearch::BFS ? "bfs" : "astar";
+	if (!watch.found()) {
+		cout << "Ա ⱸ   ϴ." << endl;
+		return;
+	}
+	if (watch.searchKind() == MazeStepSearch::DFS) {
+		watch.takePath(maze, dfsPath);
+		isdfs = true;
+	}
+	else {
+		watch.takePath(maze, bfsPath);
+		isBFS = 1;
+	}
+	const MazePath& path = watch.searchKind() == MazeStepSearch::DFS ? dfsPath : bfsPath;
+	mazeMetricSolveUs.record(watchUs);
+	mazeMetricSolveExpanded.record(watch.expanded);
+	mazeMetricSolvePath.record(path.size());
+	cout << "watch " << name << ": path " << path.size() << ", expanded " << watch.expanded
+		<< ", " << watchUs / 1000.0 << " ms" << endl;
 }
 
 
@@ -182,24 +336,19 @@ void ofApp::draw() {
 	ofSetColor(100);
 	ofSetLineWidth(5);
 	int i, j;
+	metricFrameUs.record((uint64_t)(ofGetLastFrameTime() * 1e6));
+	drawCalls = 0;
 
 	// Draw the maze if isOpen flag is true
 	if (isOpen) {
-		int maze_size = 30;
-
-		// Loop through the maze array and draw walls accordingly
-		for (int i = 0; i < HEIGHT; i++) {
-			for (int j = 0; j < WIDTH; j++) {
-				if (maze[i * WIDTH + j] & WALL_UP)
-					ofDrawLine(j * maze_size, i * maze_size, (j + 1) * maze_size, i * maze_size);
-				if (maze[i * WIDTH + j] & WALL_DOWN)
-					ofDrawLine(j * maze_size, (i + 1) * maze_size, (j + 1) * maze_size, (i + 1) * maze_size);
-				if (maze[i * WIDTH + j] & WALL_LEFT)
-					ofDrawLine(j * maze_size, i * maze_size, j * maze_size, (i + 1) * maze_size);
-				if (maze[i * WIDTH + j] & WALL_RIGHT)
-					ofDrawLine((j + 1) * maze_size, i * maze_size, (j + 1) * maze_size, (i + 1) * maze_size);
-			}
-		}
+		// ̷ ǥ(ĭ ) ȭ ű
+		ofPushMatrix();
+		ofTranslate(panX, panY);
+		ofScale(zoom, zoom);
+
+		drawWatch();
+		MazeScopedTimer timer(metricWallsUs);
+		drawWalls();
 	}
 
 	// If isdfs flag is true, draw using depth-first search algorithm
@@ -212,11 +361,57 @@ void ofApp::draw() {
 			cout << "  " << endl;
 	}
 
+	// If isBFS flag is true, draw the shortest path found by breadth-first search
+	if (isBFS) {
+		ofSetColor(255, 100, 100);
+		ofSetLineWidth(5);
+		if (isOpen)
+			bfsdraw();
+	}
+
+	if (isOpen)
+		ofPopMatrix();
+	metricDrawCalls.record(drawCalls);
+
 	// Show additional information if bShowInfo flag is true
 	if (bShowInfo) {
-		// Show title
-		sprintf(str, "");
-		myFont.drawString(str, 15, ofGetHeight() - 20);
+		// Ʒ ȭ, , Ž    
+		float y = ofGetHeight() - 20.0f;
+		sprintf(str, "   %.2f ms, ׸ %d, Ȯ %.2f, Ÿ %d (%s),  %d %.2f ms",
+			metricFrameUs.last() / 1000.0, (int)metricDrawCalls.last(), zoom, visibleTiles,
+			zoom < LOD_ZOOM ? "̹" : "޽", (int)visibleRuns, metricWallsUs.last() / 1000.0);
+		myFont.drawString(str, 15, y);
+		sprintf(str, " б %.1f ms (%.1f MB), ̷ ޸ %.1f MB", mazeMetricLoadUs.last() / 1000.0,
+			mazeMetricLoadBytes.last() / 1e6, mazeMetricGridBytes.last() / 1e6);
+		myFont.drawString(str, 15, y - 20);
+		sprintf(str, "Ž %.1f ms, Ȯ %dĭ,  %dĭ", mazeMetricSolveUs.last() / 1000.0,
+			(int)mazeMetricSolveExpanded.last(), (int)mazeMetricSolvePath.last());
+		if (solveWorker.busy()) {
+			char more[96];
+			sprintf(more, ", Ž  %dĭ %.0f ms (Esc )", (int)solveWorker.expanded(), solveWorker.elapsedMs());
+			strcat(str, more);
+		}
+		if (!watchMeshes.empty()) {
+			char more[64];
+			sprintf(more, ", Ž %dĭ (%d/)", (int)watch.expanded, (int)watchSpeed);
+			strcat(str, more);
+		}
+		myFont.drawString(str, 15, y - 40);
+	}
+
+	//  д   Ʈ    ش
+	if (loadWorker.busy()) {
+		uint64_t total = loadWorker.bytesTotal(), read = loadWorker.bytesRead();
+		float x = 15, y = ofGetHeight() - 100.0f, w = ofGetWidth() - 30.0f, h = 12;
+		ofNoFill();
+		ofSetColor(100);
+		ofDrawRectangle(x, y, w, h);
+		ofFill();
+		ofSetColor(100, 150, 255);
+		ofDrawRectangle(x, y, total ? w * read / total : 0, h);
+		ofSetColor(100);
+		sprintf(str, "ҷ  %.1f / %.1f MB (Esc )", read / 1e6, total / 1e6);
+		myFont.drawString(str, 15, y - 8);
 	}
 } // end Draw
 
@@ -276,8 +471,15 @@ void ofApp::keyPressed(int key) {
 
 	// Escape key exit has been disabled but it can be checked here
 	if (key == VK_ESCAPE) {
+		// а ִ ̳   Ž   װ Ѵ
+		if (loadWorker.busy())
+			loadWorker.cancel();
+		else if (solveWorker.busy())
+			solveWorker.cancel();
+		else if (watch.running())
+			stopWatch();
 		// Disable fullscreen set, otherwise quit the application as usual
-		if (bFullscreen) {
+		else if (bFullscreen) {
 			bFullscreen = false;
 			doFullScreen(false);
 		}
@@ -293,6 +495,24 @@ void ofApp::keyPressed(int key) {
 		menu->SetPopupItem("Show DFS", bShowInfo);
 	}
 
+	// â  ߽ Ȯ, 
+	if (key == '+' || key == '=')
+		zoomAt(ofGetWidth() / 2.0f, ofGetHeight() / 2.0f, 1.25f);
+	if (key == '-')
+		zoomAt(ofGetWidth() / 2.0f, ofGetHeight() / 2.0f, 0.8f);
+
+	// Ž  ִ ӵ  ̰ų   ø
+	if (key == '[' && watchSpeed > 1)
+		watchSpeed /= 2;
+	if (key == ']' && watchSpeed < (1 << 20))
+		watchSpeed *= 2;
+
+	// ݱ  ð Ƚ data  Ѵ
+	if (key == 'm')
+		saveMetrics(ofToDataPath("metrics.json"));
+	if (key == 'M')
+		saveMetrics(ofToDataPath("metrics.csv"));
+
 	if (key == 'f') {
 		bFullscreen = !bFullscreen;
 		doFullScreen(bFullscreen);
@@ -314,12 +534,22 @@ void ofApp::mouseMoved(int x, int y) {
 
 //--------------------------------------------------------------
 void ofApp::mouseDragged(int x, int y, int button) {
-
+	//  ư  ġ⿡ Ƿ ٸ ư  ȭ ű
+	if (button == OF_MOUSE_BUTTON_LEFT)
+		return;
+	panX += x - dragX;
+	panY += y - dragY;
+	dragX = x;
+	dragY = y;
 }
 
 //--------------------------------------------------------------
 void ofApp::mousePressed(int x, int y, int button) {
-
+	dragX = x;
+	dragY = y;
+	// ̷ΰ   Ŭ   ų 㹮
+	if (isOpen && button == OF_MOUSE_BUTTON_LEFT)
+		toggleWall(x, y);
 }
 
 //--------------------------------------------------------------
@@ -328,8 +558,18 @@ void ofApp::mouseReleased(int x, int y, int button) {
 }
 
 //--------------------------------------------------------------
-void ofApp::windowResized(int w, int h) {
+void ofApp::mouseScrolled(int x, int y, float scrollX, float scrollY) {
+	//   콺 Ű  ߽ Ȯ, 
+	zoomAt((float)x, (float)y, powf(1.1f, scrollY));
+}
 
+//--------------------------------------------------------------
+void ofApp::windowResized(int w, int h) {
+	// â ũⰡ ٲ â  ̴    Ѵ
+	panX += (w - viewWidth) / 2.0f;
+	panY += (h - viewHeight) / 2.0f;
+	viewWidth = w;
+	viewHeight = h;
 }
 
 //--------------------------------------------------------------
@@ -357,62 +597,27 @@ bool ofApp::readFile() {
 		filePath = openFileResult.getPath();
 		printf(" ̸: %s\n", fileName.c_str());
 
-		//  .maz Ȯڸ  ִ Ȯ
+		//  .maz, .mazb Ǵ .mazt Ȯڸ  ִ Ȯ
 		pos = filePath.find_last_of(".");
-		if (pos != string::npos && pos != 0 && filePath.substr(pos + 1) == "maz") {
+		string ext = pos != string::npos && pos != 0 ? filePath.substr(pos + 1) : "";
+		if (ext == "maz" || ext == "mazb" || ext == "mazt") {
 			//  ϴ Ȯ
-			ofFile file(fileName);
+			ofFile file(filePath);
 			if (!file.exists()) {
 				cout << "   ʽϴ." << endl;
 				return false;
 			}
 			else {
 				cout << "  ãҽϴ." << endl;
-				isOpen = true;
-			}
-
-			// ۿ  б
-			ofBuffer buffer(file);
-
-			// ۿ  ó
-			vector<string> lines;
-			for (auto line : buffer.getLines()) {
-				lines.push_back(line);
-			}
-
-			// ̷ ũ 
-			HEIGHT = (lines.size() - 1) / 2;
-			WIDTH = (lines[0].size() - 1) / 2;
-
-			// Է° ̷ 迭  ޸ Ҵ
-			input = (char**)malloc(sizeof(char*) * lines.size());
-			maze = (int*)malloc(sizeof(int) * HEIGHT * WIDTH);
-			memset(maze, 0, sizeof(int) * HEIGHT * WIDTH);
-
-			// Է 迭 ä
-			for (int i = 0; i < lines.size(); i++) {
-				input[i] = (char*)malloc(sizeof(char) * lines[i].size());
-				strcpy(input[i], lines[i].c_str());
 			}
 
-			// ̷   м
-			for (int i = 0; i < HEIGHT; i++) {
-				for (int j = 0; j < WIDTH; j++) {
-					int y = 1 + i * 2;
-					int x = 1 + j * 2;
-
-					if (input[y - 1][x] == '-') maze[i * WIDTH + j] |= WALL_UP;
-					if (input[y + 1][x] == '-') maze[i * WIDTH + j] |= WALL_DOWN;
-					if (input[y][x - 1] == '|') maze[i * WIDTH + j] |= WALL_LEFT;
-					if (input[y][x + 1] == '|') maze[i * WIDTH + j] |= WALL_RIGHT;
-				}
-			}
-
-			isOpen = true;
+			// ̷   м (mazeLoader) ۾ 忡 Ѵ.   update
+			// finishLoad  ̷η ٲ۴. ̹ а ִ   װ Ѵ.
+			loadWorker.start(filePath);
 			return true;
 		}
 		else {
-			printf(".maz Ȯڸ ؾ մϴ.\n");
+			printf(".maz, .mazb Ǵ .mazt Ȯڸ ؾ մϴ.\n");
 			return false;
 		}
 	}
@@ -422,20 +627,492 @@ bool ofApp::readFile() {
 	}
 }
 
-void ofApp::freeMemory() {
-
-	for (int i = 0; i < HEIGHT * 2 + 1; i++) {
-		free(input[i]);
+//  ̷θ  ̷ο ¹ٲ۴.    ̷θ ״ д.
+//isOpen ̷ΰ   ڿ Ҵ.
+void ofApp::finishLoad()
+{
+	// ۾ 尡  ̷θ а   
+	solveWorker.wait();
+	string error;
+	if (!loadWorker.take(maze, &error)) {
+		cout << loadWorker.path() << ": " << error << endl;
+		return;
 	}
 
-	free(input);
-	free(maze);
+	// ̷ ũ 
+	HEIGHT = maze.height();
+	WIDTH = maze.width();
+	isdfs = false;
+	isBFS = 0;
+	lpa.clear();
+	stopWatch();
+	zoom = 30;
+	panX = panY = 0;
+	resetTiles();
+	isOpen = true;
+	cout << "̷ " << HEIGHT << " x " << WIDTH << " оϴ." << endl;
+	seedLpa();
+}
+
+void ofApp::freeMemory() {
+
+	loadWorker.release();
+	solveWorker.wait();
+	maze.clear();
+	dfsPath.clear();
+	bfsPath.clear();
+	lpa.clear();
+	stopWatch();
+	tiles.clear();
+	tileRows = tileCols = 0;
+	meshTiles = textureTiles = 0;
+	isdfs = false;
+	isBFS = 0;
+	HEIGHT = 0;
+	WIDTH = 0;
+	isOpen = 0;
+	mazeMetricGridBytes.record(0);
+	mazeMetricGridReservedBytes.record(0);
 }
 
 bool ofApp::DFS()
 {
-	return 1;
+	isdfs = false;
+	return runSolver(*dfs);
 }
+
 void ofApp::dfsdraw()
 {
-}
\ No newline at end of file
+	drawPath(dfsPath);
+}
+
+bool ofApp::BFS()
+{
+	return shortestPath(*bfs);
+}
+
+//ִ   ã θ bfsPath ϰ  ׸ Ѵ.
+bool ofApp::shortestPath(MazeSolver& solver)
+{
+	isBFS = 0;
+	return runSolver(solver);
+}
+
+//Ž ۾ 忡 Ѵ. ̹  ִ Ž Ѵ.  update finishSolve θ.
+bool ofApp::runSolver(MazeSolver& solver)
+{
+	solveWorker.start(maze, solver);
+	return true;
+}
+
+// Ž θ  ʰ dfsPath Ǵ bfsPath ¹ٲپ ް,
+// ̸,  , Ȯ  , ɸ ð Ѵ.
+void ofApp::finishSolve()
+{
+	MazeSolver* solver = solveWorker.solver();
+	if (solver == lpaSeed.get()) {
+		// δ ׸ ʰ,  ĥ  ̾  Ž ¸ 
+		MazePath seedPath;
+		solveWorker.take(seedPath);
+		if (!solveWorker.wasCancelled())
+			cout << "lpa: غ, expanded " << solveWorker.expanded() << ", " << solveWorker.elapsedMs() << " ms" << endl;
+		return;
+	}
+	bool isDfsSolver = solver == dfs.get();
+	MazePath& path = isDfsSolver ? dfsPath : bfsPath;
+	bool found = solveWorker.take(path);
+	bool cancelled = solveWorker.wasCancelled();
+	size_t expanded = solveWorker.expanded();
+	double ms = solveWorker.elapsedMs();
+	//  Ž LPA* ù Ž   ٽ 
+	if (isOpen && !lpa.ready(maze))
+		seedLpa();
+	if (cancelled) {
+		cout << solver->name() << ": Ž ߽ϴ." << endl;
+		return;
+	}
+	if (!found) {
+		cout << "Ա ⱸ   ϴ." << endl;
+		return;
+	}
+	if (isDfsSolver)
+		isdfs = true;
+	else
+		isBFS = 1;
+	cout << solver->name() << ": path " << path.size() << ", expanded " << expanded
+		<< ", " << ms << " ms" << endl;
+}
+
+// ĥ  LPA*  Ž ̾ ĥ  ֵ, ù Ž ۾ 忡  д.
+//ū ̷ο Ŭ  ȿ  ȭ 忡 ó ã ʴ´.
+void ofApp::seedLpa()
+{
+	solveWorker.start(maze, *lpaSeed);
+}
+
+void ofApp::bfsdraw()
+{
+	drawPath(bfsPath);
+}
+
+void ofApp::drawPath(const MazePath& path)
+{
+	// ̷ ǥ ĭ  մ´ (draw ȭ ű)
+	int row = path.startRow;
+	int col = path.startCol;
+
+	// One line per straight run of the path
+	size_t i = 0;
+	while (i < path.size()) {
+		int dir = path[i];
+		int r0 = row, c0 = col;
+		for (; i < path.size() && path[i] == dir; i++) {
+			row += MAZE_DROW[dir];
+			col += MAZE_DCOL[dir];
+		}
+		ofDrawLine(c0 + 0.5f, r0 + 0.5f, col + 0.5f, row + 0.5f);
+		drawCalls++;
+	}
+}
+
+//Ŭ     ų 㹰, LPA* ִ θ ģ.
+// ̿  ĭ Բ  Ʈ ϳ̹Ƿ  ĭ    ٲ.
+bool ofApp::toggleWall(int x, int y)
+{
+	//    ŭ   ġ ʴ´
+	if (zoom < LOD_ZOOM)
+		return false;
+	float wx = (x - panX) / zoom, wy = (y - panY) / zoom;
+	if (wx < 0 || wy < 0)
+		return false;
+	int row = (int)wy;
+	int col = (int)wx;
+	if (row >= HEIGHT || col >= WIDTH)
+		return false;
+
+	// ĭ    Ŭ     
+	float fx = wx - col, fy = wy - row;
+	float gap[4] = { fy, 1 - fx, 1 - fy, fx };
+	int dir = DIR_UP;
+	for (int d = 1; d < 4; d++)
+		if (gap[d] < gap[dir])
+			dir = d;
+	if (gap[dir] > 0.25f)
+		return false; // ĭ   Ѵ
+	int nr = row + MAZE_DROW[dir];
+	int nc = col + MAZE_DCOL[dir];
+	if (nr < 0 || nr >= HEIGHT || nc < 0 || nc >= WIDTH)
+		return false; // ٱ  ״ д
+
+	solveWorker.wait(); // ۾ 尡 а ִ ̷δ ٲ ʴ´ (Ž ٷ )
+	maze.setWall(row, col, dir, maze.canMove(row, col, dir));
+	invalidateTiles(row, col, dir);
+	isdfs = false; // DFS δ     Ƿ 
+	stopWatch(); //   Ž ٲ  ̷θ  ִ
+
+	// LPA* ù Ž   ʾ ĥ Ž . ̹  ġ
+	// ٲ ̷η ۾ 忡 ٽ ã´.  ִ δ  Ƿ .
+	if (!lpa.ready(maze)) {
+		isBFS = 0;
+		seedLpa();
+		return true;
+	}
+
+	uint64_t t0 = ofGetElapsedTimeMicros();
+	bool found = lpa.wallChanged(maze, row, col, dir, bfsPath);
+	uint64_t us = ofGetElapsedTimeMicros() - t0;
+	double ms = us / 1000.0;
+	isBFS = found;
+	mazeMetricSolveUs.record(us);
+	mazeMetricSolveExpanded.record(lpa.expanded);
+	if (found)
+		mazeMetricSolvePath.record(bfsPath.size());
+	if (!found) {
+		cout << "Ա ⱸ   ϴ." << endl;
+		return true;
+	}
+	cout << "lpa: path " << bfsPath.size() << ", touched " << lpa.touched << ", expanded " << lpa.expanded
+		<< ", " << ms << " ms" << endl;
+	return true;
+}
+
+//콺 ġ (x, y) ִ ̷  ״  Ȯ  factor Ѵ.
+void ofApp::zoomAt(float x, float y, float factor)
+{
+	float wx = (x - panX) / zoom, wy = (y - panY) / zoom;
+	zoom *= factor;
+	if (zoom < MIN_ZOOM) zoom = MIN_ZOOM;
+	if (zoom > MAX_ZOOM) zoom = MAX_ZOOM;
+	panX = x - wx * zoom;
+	panY = y - wy * zoom;
+}
+
+// ̷ο ° Ÿ . ޽ÿ ؽó ȭ鿡   .
+void ofApp::resetTiles()
+{
+	tiles.clear();
+	tileRows = (HEIGHT + TILE - 1) / TILE;
+	tileCols = (WIDTH + TILE - 1) / TILE;
+	tiles.resize((size_t)tileRows * tileCols);
+	meshTiles = textureTiles = 0;
+}
+
+// ϳ ٲ   ̿   ĭ Ÿϸ ٽ .
+void ofApp::invalidateTiles(int row, int col, int dir)
+{
+	int cells[2][2] = { { row, col }, { row + MAZE_DROW[dir], col + MAZE_DCOL[dir] } };
+	for (int i = 0; i < 2; i++) {
+		int r = cells[i][0], c = cells[i][1];
+		if (r < 0 || r >= HEIGHT || c < 0 || c >= WIDTH)
+			continue;
+		RenderTile* tile = tiles[(size_t)(r / TILE) * tileCols + c / TILE].get();
+		if (!tile)
+			continue;
+		if (tile->hasMesh) {
+			tile->mesh.clear();
+			tile->hasMesh = false;
+			meshTiles--;
+		}
+		if (tile->hasTexture) {
+			tile->texture.clear();
+			tile->hasTexture = false;
+			textureTiles--;
+		}
+	}
+}
+
+//ȭ鿡 ̴ Ÿϸ ׸. Ȯ   ޽ø,   ؽó ,
+//  Ÿ Ӹ  ð ȿ   и ʰ Ѵ.
+void ofApp::drawWalls()
+{
+	frameCount++;
+	visibleTiles = 0;
+	visibleRuns = 0;
+	if (tiles.empty())
+		return;
+
+	// ȭ鿡  ̷  (ĭ )
+	float left = -panX / zoom, top = -panY / zoom;
+	float right = (ofGetWidth() - panX) / zoom, bottom = (ofGetHeight() - panY) / zoom;
+	int tc0 = std::max(0, (int)floorf(left / TILE)), tc1 = std::min(tileCols - 1, (int)floorf(right / TILE));
+	int tr0 = std::max(0, (int)floorf(top / TILE)), tr1 = std::min(tileRows - 1, (int)floorf(bottom / TILE));
+
+	bool lod = zoom < LOD_ZOOM;
+	uint64_t deadline = ofGetElapsedTimeMicros() + BUILD_BUDGET_US;
+	bool built = false;
+	ofSetColor(lod ? 255 : 100);
+	// ؽó  ĭ Ʒ Ž ǥð ġ ϱ ´
+	if (lod)
+		ofEnableBlendMode(OF_BLENDMODE_MULTIPLY);
+	for (int tr = tr0; tr <= tr1; tr++) {
+		for (int tc = tc0; tc <= tc1; tc++) {
+			int t = tr * tileCols + tc;
+			if (!tiles[t]) {
+				tiles[t].reset(new RenderTile());
+				tiles[t]->hasMesh = tiles[t]->hasTexture = false;
+				tiles[t]->runs = 0;
+			}
+			RenderTile& tile = *tiles[t];
+			tile.used = frameCount;
+
+			bool ready = lod ? tile.hasTexture : tile.hasMesh;
+			if (!ready && (!built || ofGetElapsedTimeMicros() < deadline)) {
+				if (lod)
+					buildTileTexture(t);
+				else
+					buildTileMesh(t);
+				built = ready = true;
+			}
+			if (!ready)
+				continue;
+
+			visibleTiles++;
+			if (lod) {
+				// ؽó ڸ ȼ ٱ  ̹Ƿ  ȼ а ׸
+				int rows = std::min(TILE, HEIGHT - tr * TILE), cols = std::min(TILE, WIDTH - tc * TILE);
+				tile.texture.draw(tc * TILE - 0.25f, tr * TILE - 0.25f, cols + 0.5f, rows + 0.5f);
+			}
+			else {
+				tile.mesh.draw();
+				visibleRuns += tile.runs;
+			}
+			drawCalls++;
+		}
+	}
+	if (lod)
+		ofEnableAlphaBlending();
+	evictTiles(lod);
+}
+
+//Ÿ  ̾    ٸ 簢 ϳ ޽ÿ ´ (̷ ǥ).
+// ĭ Բ    ŸϿ   ,  β ݸŭ ÷ 𼭸  ʰ Ѵ.
+void ofApp::buildTileMesh(int t)
+{
+	MazeScopedTimer timer(metricTileMeshUs);
+	RenderTile& tile = *tiles[t];
+	int row0 = t / tileCols * TILE, col0 = t % tileCols * TILE;
+	std::vector<MazeWallRun> runs;
+	mazeWallRuns(maze, row0, col0, std::min(row0 + TILE, HEIGHT), std::min(col0 + TILE, WIDTH), runs);
+
+	float half = 2.5f / 30; // 30ȼ ĭ β 5
+	std::vector<ofVec3f> vertices;
+	std::vector<ofIndexType> indices;
+	vertices.reserve(runs.size() * 4);
+	indices.reserve(runs.size() * 6);
+	for (size_t i = 0; i < runs.size(); i++) {
+		const MazeWallRun& run = runs[i];
+		float at = (float)run.line;
+		float from = (float)run.from - half;
+		float to = (float)run.to + half;
+		float x0 = run.vertical ? at - half : from, x1 = run.vertical ? at + half : to;
+		float y0 = run.vertical ? from : at - half, y1 = run.vertical ? to : at + half;
+
+		ofIndexType base = (ofIndexType)vertices.size();
+		vertices.push_back(ofVec3f(x0, y0, 0));
+		vertices.push_back(ofVec3f(x1, y0, 0));
+		vertices.push_back(ofVec3f(x1, y1, 0));
+		vertices.push_back(ofVec3f(x0, y1, 0));
+		ofIndexType quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+		indices.insert(indices.end(), quad, quad + 6);
+	}
+
+	tile.mesh.clear();
+	tile.mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+	tile.mesh.setUsage(GL_STATIC_DRAW);
+	tile.mesh.addVertices(vertices);
+	tile.mesh.addIndices(indices);
+	tile.runs = runs.size();
+	if (!tile.hasMesh)
+		meshTiles++;
+	tile.hasMesh = true;
+}
+
+//Ÿ ĭ   ȼ ׸  ؽó . Ӹ ξ  ص   ̰ Ѵ.
+void ofApp::buildTileTexture(int t)
+{
+	MazeScopedTimer timer(metricTileTextureUs);
+	RenderTile& tile = *tiles[t];
+	int row0 = t / tileCols * TILE, col0 = t % tileCols * TILE;
+	int row1 = std::min(row0 + TILE, HEIGHT), col1 = std::min(col0 + TILE, WIDTH);
+	int w = 2 * (col1 - col0) + 1, h = 2 * (row1 - row0) + 1;
+
+	ofPixels pixels;
+	pixels.allocate(w, h, OF_IMAGE_GRAYSCALE);
+	mazeRasterize(maze, row0, col0, row1, col1, 100, 255, pixels.getData(), w);
+	// Ӹ 簢(ARB) ؽó   Ƿ GL_TEXTURE_2D 
+	tile.texture.allocate(pixels, false);
+	tile.texture.loadData(pixels);
+	tile.texture.generateMipmap();
+	tile.texture.setTextureMinMagFilter(GL_LINEAR_MIPMAP_LINEAR, GL_NEAREST);
+	if (!tile.hasTexture)
+		textureTiles++;
+	tile.hasTexture = true;
+}
+
+//޽ó ؽó  Ÿ ʹ     ׸ ͺ .
+void ofApp::evictTiles(bool textures)
+{
+	size_t limit = textures ? MAX_TEXTURE_TILES : MAX_MESH_TILES;
+	size_t& count = textures ? textureTiles : meshTiles;
+	if (count <= limit)
+		return;
+
+	std::vector<std::pair<uint64_t, size_t> > held;
+	for (size_t t = 0; t < tiles.size(); t++) {
+		RenderTile* tile = tiles[t].get();
+		if (tile && (textures ? tile->hasTexture : tile->hasMesh) && tile->used != frameCount)
+			held.push_back(std::make_pair(tile->used, t));
+	}
+	//   ˳     ʰ Ѵ
+	size_t drop = std::min(held.size(), count - limit * 3 / 4);
+	std::partial_sort(held.begin(), held.begin() + drop, held.end());
+	for (size_t i = 0; i < drop; i++) {
+		RenderTile& tile = *tiles[held[i].second];
+		if (textures) {
+			tile.texture.clear();
+			tile.hasTexture = false;
+		}
+		else {
+			tile.mesh.clear();
+			tile.hasMesh = false;
+		}
+		count--;
+	}
+}
+
+//kind Ž ó Ѵ. update Ӹ ݾ Ѵ.
+void ofApp::startWatch(MazeStepSearch::Kind kind)
+{
+	stopWatch();
+	if (kind == MazeStepSearch::DFS)
+		isdfs = false;
+	else
+		isBFS = 0;
+	watch.start(maze, kind);
+	appendWatchCells();
+}
+
+//  Ž ߰ Ž ǥø .
+void ofApp::stopWatch()
+{
+	watch.stop();
+	watch.opened.clear();
+	watch.closed.clear();
+	watchMeshes.clear();
+	watchQuads = 0;
+	watchUs = 0;
+}
+
+//  ڷ ⿭  ĭ(Ķ) 湮 ģ ĭ() ޽ ڿ δ.
+//湮 ģ ĭ ⿭    簢  ٽ ׷.
+//޽ð WATCH_CHUNK ĭ ä  ޽ø  Ӹ GPU ø   д.
+void ofApp::appendWatchCells()
+{
+	const std::vector<uint64_t>* lists[2] = { &watch.opened, &watch.closed };
+	const ofFloatColor colors[2] = { ofFloatColor(0.7f, 0.85f, 1.0f), ofFloatColor(1.0f, 0.9f, 0.55f) };
+	for (int k = 0; k < 2; k++) {
+		const std::vector<uint64_t>& cells = *lists[k];
+		for (size_t i = 0; i < cells.size(); i++) {
+			if (watchMeshes.empty() || watchQuads == WATCH_CHUNK) {
+				watchMeshes.push_back(std::unique_ptr<ofVboMesh>(new ofVboMesh()));
+				watchMeshes.back()->setMode(OF_PRIMITIVE_TRIANGLES);
+				watchMeshes.back()->setUsage(GL_DYNAMIC_DRAW);
+				watchQuads = 0;
+			}
+			ofVboMesh& mesh = *watchMeshes.back();
+			float x = (float)(cells[i] % WIDTH), y = (float)(cells[i] / WIDTH);
+			ofIndexType base = (ofIndexType)mesh.getNumVertices();
+			mesh.addVertex(ofVec3f(x, y, 0));
+			mesh.addVertex(ofVec3f(x + 1, y, 0));
+			mesh.addVertex(ofVec3f(x + 1, y + 1, 0));
+			mesh.addVertex(ofVec3f(x, y + 1, 0));
+			for (int v = 0; v < 4; v++)
+				mesh.addColor(colors[k]);
+			ofIndexType quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+			for (int v = 0; v < 6; v++)
+				mesh.addIndex(quad[v]);
+			watchQuads++;
+		}
+	}
+	watch.opened.clear();
+	watch.closed.clear();
+}
+
+//Ž ǥø  Ʒ ׸ (̷ ǥ).
+void ofApp::drawWatch()
+{
+	ofSetColor(255);
+	for (size_t i = 0; i < watchMeshes.size(); i++)
+		watchMeshes[i]->draw();
+	drawCalls += (int)watchMeshes.size();
+}
+
+//ݱ  ð Ƚ Ͽ . Ȯڰ .csv̸ CSV, ƴϸ JSON .
+void ofApp::saveMetrics(const string& file)
+{
+	string error;
+	if (mazeWriteMetrics(file, &error))
+		cout << file << "  ߽ϴ." << endl;
+	else
+		cout << file << ": " << error << endl;
+}
@@ -26,12 +26,17 @@
 
 #include "ofMain.h"
 #include "ofxWinMenu.h" // Menu addon'
-
-// wall bit flag
-#define WALL_UP 0b1000
-#define WALL_RIGHT 0b0100
-#define WALL_DOWN 0b0010
-#define WALL_LEFT 0b0001
+#include "mazeGrid.h" // WALL_* flags and wall grid
+#include "mazeLoader.h"
+#include "mazeLoadWorker.h" // ̷  д ۾ 
+#include "mazeSolver.h" // dfs, bfs, pbfs, astar, jps Ž 
+#include "mazeLpa.h" //  ģ  ִ θ ̾ ġ LPA*
+#include "mazeWallRuns.h" //  ̾   ´
+#include "mazeRaster.h" // ؼ    Ÿ ̹
+#include "mazeStepSearch.h" // ݾ ̾   ִ DFS, BFS, A*
+#include "mazeSolveWorker.h" // Ž  ۾ 
+#include "mazeMetrics.h" //  б, Ž, ׸⿡ ɸ ð Ƚ
+#include <memory>
 
 class ofApp : public ofBaseApp {
 
@@ -47,22 +52,85 @@ public:
 	void mouseDragged(int x, int y, int button);
 	void mousePressed(int x, int y, int button);
 	void mouseReleased(int x, int y, int button);
+	void mouseScrolled(int x, int y, float scrollX, float scrollY);
 	void windowResized(int w, int h);
 	void dragEvent(ofDragInfo dragInfo);
 	void gotMessage(ofMessage msg);
 	bool readFile();
+	void finishLoad();
 	void freeMemory();
 	bool DFS();
 	void dfsdraw();
+	bool BFS();
+	bool shortestPath(MazeSolver& solver);
+	bool runSolver(MazeSolver& solver);
+	void finishSolve();
+	void seedLpa();
+	void bfsdraw();
+	void drawPath(const MazePath& path);
+	bool toggleWall(int x, int y);
+	void zoomAt(float x, float y, float factor);
+	void resetTiles();
+	void invalidateTiles(int row, int col, int dir);
+	void drawWalls();
+	void buildTileMesh(int t);
+	void buildTileTexture(int t);
+	void evictTiles(bool textures);
+	void startWatch(MazeStepSearch::Kind kind);
+	void stopWatch();
+	void appendWatchCells();
+	void drawWatch();
+	void saveMetrics(const string& file);
 	int HEIGHT;//̷ 
 	int WIDTH;//̷ ʺ
-	char** input;//ؽƮ      迭̴.
-	int* maze; //̷ Graph
-	int** visited;//湮θ  
+	MazeGrid maze; //̷ Graph
+	std::unique_ptr<MazeSolver> dfs; //湮 Ʈ° Ž   DFS 
+	MazePath dfsPath; //DFS ã  ( )
+	std::unique_ptr<MazeSolver> bfs; //ִ θ ã BFS 
+	std::unique_ptr<MazeSolver> pbfs; // ھ  BFS 
+	std::unique_ptr<MazeSolver> astar; //ư Ÿ ޸ƽ  A* 
+	std::unique_ptr<MazeSolver> jps; //θ ǳʶٴ  Ʈ Ž 
+	std::unique_ptr<MazeSolver> bibfs; //Ա ⱸ ʿ ÿ ã BFS 
+	std::unique_ptr<MazeSolver> biastar; //Ա ⱸ ʿ ÿ ã A* 
+	MazePath bfsPath; //ִ  (BFS, A*, JPS, ) ã 
+	MazeLpa lpa; // ĥ   Ž ٲ κи ٽ ã 
+	std::unique_ptr<MazeSolver> lpaSeed; //lpa ù Ž ۾ 忡  
+	// ޴  Ž ۾ 忡  â  ʰ Ѵ.  ̷, κ
+	// ڿ ξ  Ҹǰ Ѵ (Ҹڰ 带 ߰ ٸ).
+	MazeSolveWorker solveWorker;
+	MazeLoadWorker loadWorker; // д ۾ .   ̷δ update maze ¹ٲ۴
+	// ȭ ̵ Ȯ. ȭ ǥ = ̷ ǥ(ĭ ) * zoom + pan
+	float zoom; //ĭ ϳ ȭ ũ (ȼ)
+	float panX, panY; //̷   𼭸 ȭ ġ
+	int dragX, dragY; //⸦ (Ǵ  ó) 콺 ġ
+	int viewWidth, viewHeight; // ˷ â ũ
+	// ̷θ TILE x TILE ĭ ŸϷ  ȭ鿡 ̴ Ÿϸ ׸.
+	// Ȯ   ޽,   ̸ ׷  ؽó .
+	struct RenderTile {
+		ofVboMesh mesh; // ̾ ٸ 簢 ϳ  ޽
+		ofTexture texture; //ĭ   ȼ ׸ ̹
+		bool hasMesh, hasTexture;
+		size_t runs; //޽ÿ    
+		uint64_t used; // ׸ 
+	};
+	std::vector<std::unique_ptr<RenderTile> > tiles;
+	int tileRows, tileCols;
+	size_t meshTiles, textureTiles; //޽, ؽó  Ÿ 
+	uint64_t frameCount;
+	int visibleTiles; // ӿ ׸ Ÿ 
+	size_t visibleRuns; // ӿ ׸   
+	int drawCalls; //̹ ӿ ̷θ ׸   ׸ ȣ 
+	// Ž     ش. update Ӹ ݾ ϰ,
+	//  ⿭  ĭ 湮 ģ ĭ ޽ ڿ δ.
+	MazeStepSearch watch; //Ӹ ݾ ϴ Ž
+	std::vector<std::unique_ptr<ofVboMesh> > watchMeshes; //ĭ 簢 ϳ.  ޽ÿ δ
+	size_t watchQuads; // ޽ÿ  簢 
+	size_t watchSpeed; // ӿ  ִ ܰ 
+	uint64_t watchUs; //ݱ Ž  ð (ũ)
 	int maze_col;//̷ĭ  ε Ų.
 	int maze_row;//̷ĭ  ε Ų.
 	int k;
-	int isOpen; // ȴ Ǵϴ . 0̸ ȿȰ 1̸ ȴ.
+	int isOpen; //̷θ  о Ǵϴ . 0̸ ȿȰ 1̸ ȴ.
 	int isDFS;//DFSԼ ״ Ǵϴ . 0̸ ߰ 1̸ ߴ.
 	int isBFS;//BFSԼ ״ Ǵϴ . 0̸ ߰ 1̸ ߴ.
 	// Menu
@@ -0,0 +1,320 @@
+/*
+
+	mazebench - timings of the maze hot paths, as JSON
+
+	Usage:
+		mazebench [-max cells] [-seed n] [-t threads] [-tmp dir] [-o out.json]
+			Generate a perfect maze of 10^2, 10^3, ... up to max cells
+			(default 10^8) and time every stage on it separately:
+			generation (Eller, and tiled on threads), the .maz text parse
+			that the app's readFile does, the dfs, bfs, astar and biastar
+			solves, and building the wall meshes the app draws, tile by
+			tile.
+			Small mazes repeat a stage until it has run for a while and
+			report the mean.
+
+			Every stage reports its time, cells per second, nodes expanded
+			per second for solves, the allocations it made, and the peak
+			resident set size of the process so far. The JSON goes to out,
+			or to stdout; progress goes to stderr. The .maz text is written
+			to dir (default: the current directory) and removed after.
+
+			Every size also checks that bidirectional A* expanded fewer
+			cells than A*, as biastarBelowAstar, and warns on stderr when
+			it did not.
+
+*/
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "mazeEller.h"
+#include "mazeGrid.h"
+#include "mazeLoader.h"
+#include "mazeParallelGen.h"
+#include "mazeSolver.h"
+#include "mazeThreadPool.h"
+#include "mazeWallRuns.h"
+
+using namespace std;
+
+//--------------------------------------------------------------
+// Every allocation in the process goes through these, so a stage can
+// count what it allocated
+
+static atomic<uint64_t> allocCount(0);
+static atomic<uint64_t> allocBytes(0);
+
+void* operator new(size_t size)
+{
+	allocCount.fetch_add(1, memory_order_relaxed);
+	allocBytes.fetch_add(size, memory_order_relaxed);
+	void* p = malloc(size ? size : 1);
+	if (!p)
+		throw bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+	allocCount.fetch_add(1, memory_order_relaxed);
+	allocBytes.fetch_add(size, memory_order_relaxed);
+	return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+static uint64_t peakRssBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return (uint64_t)usage.ru_maxrss;
+#else
+	return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+//--------------------------------------------------------------
+
+// Tile size of the app's wall meshes (TILE in ofApp.cpp)
+static const int MESH_TILE = 64;
+// Small mazes repeat a stage until it has run this long, at most MAX_RUNS times
+static const double MIN_STAGE_MS = 200;
+static const int MAX_RUNS = 1000;
+
+static double msSince(chrono::steady_clock::time_point t0)
+{
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// One timed stage on one maze
+struct Stage {
+	string name;
+	int runs;
+	double ms; // mean per run
+	double minMs;
+	uint64_t allocations; // per run
+	uint64_t allocatedBytes;
+	uint64_t peakRss;
+	// Stage specific counts, per run; 0 when they do not apply
+	uint64_t nodes;
+	uint64_t pathLength;
+	uint64_t quads;
+	uint64_t bytes;
+};
+
+// Run fn until MIN_STAGE_MS has passed, counting time and allocations
+template <class Fn>
+static Stage timeStage(const char* name, Fn fn)
+{
+	Stage stage;
+	stage.name = name;
+	stage.nodes = stage.pathLength = stage.quads = stage.bytes = 0;
+	stage.minMs = 1e300;
+	uint64_t count0 = allocCount.load(), bytes0 = allocBytes.load();
+	double total = 0;
+	int runs = 0;
+	while (runs < MAX_RUNS && (runs == 0 || total < MIN_STAGE_MS)) {
+		chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+		fn(stage);
+		double ms = msSince(t0);
+		total += ms;
+		if (ms < stage.minMs)
+			stage.minMs = ms;
+		runs++;
+	}
+	stage.runs = runs;
+	stage.ms = total / runs;
+	stage.allocations = (allocCount.load() - count0) / runs;
+	stage.allocatedBytes = (allocBytes.load() - bytes0) / runs;
+	stage.peakRss = peakRssBytes();
+	return stage;
+}
+
+// Wall runs of every MESH_TILE tile turned into quads, allocated the way
+// ofApp::buildTileMesh does, less the upload
+static uint64_t buildMeshes(const MazeGrid& grid)
+{
+	struct Vertex { float x, y, z; };
+	uint64_t quads = 0;
+	float half = 2.5f / 30;
+	for (int row0 = 0; row0 < grid.height(); row0 += MESH_TILE) {
+		for (int col0 = 0; col0 < grid.width(); col0 += MESH_TILE) {
+			vector<MazeWallRun> runs;
+			mazeWallRuns(grid, row0, col0, min(row0 + MESH_TILE, grid.height()), min(col0 + MESH_TILE, grid.width()), runs);
+			vector<Vertex> vertices;
+			vector<uint32_t> indices;
+			vertices.reserve(runs.size() * 4);
+			indices.reserve(runs.size() * 6);
+			for (size_t i = 0; i < runs.size(); i++) {
+				const MazeWallRun& run = runs[i];
+				float at = (float)run.line, from = run.from - half, to = run.to + half;
+				float x0 = run.vertical ? at - half : from, x1 = run.vertical ? at + half : to;
+				float y0 = run.vertical ? from : at - half, y1 = run.vertical ? to : at + half;
+				uint32_t base = (uint32_t)vertices.size();
+				Vertex quad[4] = { { x0, y0, 0 }, { x1, y0, 0 }, { x1, y1, 0 }, { x0, y1, 0 } };
+				vertices.insert(vertices.end(), quad, quad + 4);
+				uint32_t tri[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+				indices.insert(indices.end(), tri, tri + 6);
+			}
+			quads += runs.size();
+		}
+	}
+	return quads;
+}
+
+static void printStage(FILE* out, const Stage& s, uint64_t cells, bool last)
+{
+	double perSec = s.ms > 0 ? 1000.0 / s.ms : 0;
+	fprintf(out, "        { \"stage\": \"%s\", \"runs\": %d, \"ms\": %.6f, \"minMs\": %.6f, \"cellsPerSec\": %.0f",
+		s.name.c_str(), s.runs, s.ms, s.minMs, cells * perSec);
+	if (s.nodes)
+		fprintf(out, ", \"nodesExpanded\": %llu, \"nodesPerSec\": %.0f, \"pathLength\": %llu",
+			(unsigned long long)s.nodes, s.nodes * perSec, (unsigned long long)s.pathLength);
+	if (s.quads)
+		fprintf(out, ", \"quads\": %llu, \"quadsPerSec\": %.0f", (unsigned long long)s.quads, s.quads * perSec);
+	if (s.bytes)
+		fprintf(out, ", \"bytes\": %llu, \"bytesPerSec\": %.0f", (unsigned long long)s.bytes, s.bytes * perSec);
+	fprintf(out, ", \"allocations\": %llu, \"allocatedBytes\": %llu, \"peakRssBytes\": %llu }%s\n",
+		(unsigned long long)s.allocations, (unsigned long long)s.allocatedBytes,
+		(unsigned long long)s.peakRss, last ? "" : ",");
+}
+
+int main(int argc, char** argv)
+{
+	uint64_t maxCells = 100000000;
+	uint64_t seed = 1;
+	int threads = 0;
+	string tmpDir = ".";
+	string outFile;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-max") == 0 && i + 1 < argc)
+			maxCells = strtoull(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc)
+			seed = strtoull(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-tmp") == 0 && i + 1 < argc)
+			tmpDir = argv[++i];
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			outFile = argv[++i];
+		else {
+			printf("usage: %s [-max cells] [-seed n] [-t threads] [-tmp dir] [-o out.json]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (threads <= 0)
+		threads = MazeThreadPool::hardwareThreads();
+
+	FILE* out = outFile.empty() ? stdout : fopen(outFile.c_str(), "w");
+	if (!out) {
+		fprintf(stderr, "%s: cannot create file\n", outFile.c_str());
+		return 1;
+	}
+	string tmpFile = tmpDir + "/mazebench.tmp.maz";
+	const char* solvers[] = { "dfs", "bfs", "astar", "biastar" };
+
+	fprintf(out, "{\n  \"benchmark\": \"mazebench\",\n  \"seed\": %llu,\n  \"threads\": %d,\n  \"sizes\": [\n",
+		(unsigned long long)seed, threads);
+	bool ok = true;
+	// Each size is written whole once it is measured, with the separator
+	// before it, so a run that stops early still leaves valid JSON
+	int sizes = 0;
+	for (uint64_t cells = 100; ok && cells <= maxCells; cells *= 10) {
+		// As square as the power of ten allows
+		int height = (int)pow(10.0, floor(log10((double)cells) / 2));
+		int width = (int)(cells / height);
+		fprintf(stderr, "%d x %d\n", height, width);
+		vector<Stage> stages;
+		MazeGrid grid;
+
+		stages.push_back(timeStage("generate", [&](Stage&) { generateMaze(grid, height, width, seed); }));
+		stages.push_back(timeStage("generateTiles", [&](Stage&) { generateMazeParallel(grid, height, width, seed, threads); }));
+
+		// The parse readFile does, from a .maz written by this maze
+		string error;
+		if (!saveMaz(grid, tmpFile, &error)) {
+			fprintf(stderr, "%s: %s\n", tmpFile.c_str(), error.c_str());
+			ok = false;
+			break;
+		}
+		stages.push_back(timeStage("parse", [&](Stage& s) {
+			MazeLoadProgress progress;
+			ok = loadMazeFile(tmpFile, grid, &error, &progress) && ok;
+			s.bytes = progress.bytesRead.load();
+		}));
+		remove(tmpFile.c_str());
+		if (!ok) {
+			fprintf(stderr, "%s: %s\n", tmpFile.c_str(), error.c_str());
+			break;
+		}
+
+		for (size_t i = 0; i < sizeof(solvers) / sizeof(solvers[0]); i++) {
+			unique_ptr<MazeSolver> solver(createMazeSolver(solvers[i]));
+			MazePath path;
+			string name = string("solve.") + solvers[i];
+			stages.push_back(timeStage(name.c_str(), [&](Stage& s) {
+				solver->solve(grid, path);
+				s.nodes = solver->nodesExpanded();
+				s.pathLength = path.size();
+			}));
+		}
+
+		// The solve stages are the last four so far
+		const Stage& astar = stages[stages.size() - 2];
+		const Stage& biastar = stages[stages.size() - 1];
+		bool biastarBelow = biastar.nodes < astar.nodes;
+		if (!biastarBelow)
+			fprintf(stderr, "biastar expanded %llu cells, not fewer than astar's %llu\n",
+				(unsigned long long)biastar.nodes, (unsigned long long)astar.nodes);
+
+		stages.push_back(timeStage("mesh", [&](Stage& s) { s.quads = buildMeshes(grid); }));
+
+		fprintf(out, "%s    {\n      \"cells\": %llu,\n      \"height\": %d,\n      \"width\": %d,\n      \"biastarBelowAstar\": %s,\n      \"stages\": [\n",
+			sizes++ ? ",\n" : "", (unsigned long long)cells, height, width, biastarBelow ? "true" : "false");
+		for (size_t i = 0; i < stages.size(); i++)
+			printStage(out, stages[i], cells, i + 1 == stages.size());
+		fprintf(out, "      ]\n    }");
+		fflush(out);
+	}
+	fprintf(out, "%s  ]\n}\n", sizes ? "\n" : "");
+	if (out != stdout)
+		fclose(out);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,597 @@
+/*
+
+	mazecli - headless maze loader and solver
+
+	Usage:
+		mazecli [-s solvers] [-t threads] [-c cacheMB] <file.maz | file.mazb | file.mazt>
+			Load a maze, solve it from entrance to exit and print timings.
+			solvers is a comma separated list of dfs, bfs, wave, wave-s,
+			pbfs, astar, jps, bibfs, biastar, lpa (default: all). All but wave
+			and pbfs run in place on a mapped .mazb, or on a .mazt through
+			a tile cache of cacheMB megabytes (default 64).
+			threads sets the pbfs thread count (default: all hardware threads).
+		mazecli scale <file> [threads]
+			Time pbfs with 1, 2, 4, ... up to threads threads.
+		mazecli convert <in> <out>
+			Convert between .maz, .mazb and .mazt. The output format
+			follows the extension of out.
+		mazecli oracle <file> [queries]
+			Preprocess a perfect maze for constant time distance queries,
+			then time a batch of random distance and path queries.
+		mazecli hpa <file> [queries] [clusterSize]
+			Build an HPA* hierarchy for a maze with loops and time a batch
+			of random queries against flat A*, then time cluster rebuilds
+			after random wall changes.
+		mazecli edit <file> [edits]
+			Flip random walls one at a time and repair the shortest path
+			with LPA* after each, against a full A* search.
+		mazecli render <file> <out.png | out.ppm> [cellPixels] [wallPixels] [solver] [threads]
+			Draw the maze to an image without a GPU, in bands on threads
+			threads (default: all hardware threads) and streamed to out.
+			Cells are cellPixels wide (default 4) and walls wallPixels
+			(default 1). With solver (a name as for -s) its path is drawn.
+		mazecli generate <out> <height> <width> [seed] [threads]
+			Stream a perfect maze made with Eller's algorithm to out, .maz
+			text, .mazb or tiled .mazt by the extension. Only one row (one
+			band of tiles for .mazt) is held in memory.
+			With threads the maze is made in tiles on that many threads
+			(0 = all hardware threads) in memory, then saved.
+
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mazeAstar.h"
+#include "mazeBfs.h"
+#include "mazeBidirectional.h"
+#include "mazeBinary.h"
+#include "mazeDfs.h"
+#include "mazeEller.h"
+#include "mazeGrid.h"
+#include "mazeHpa.h"
+#include "mazeImage.h"
+#include "mazeJps.h"
+#include "mazeLoader.h"
+#include "mazeLpa.h"
+#include "mazeParallelBfs.h"
+#include "mazeParallelGen.h"
+#include "mazeSolver.h"
+#include "mazeTiledGrid.h"
+#include "mazeTreeOracle.h"
+
+using namespace std;
+
+static double msSince(chrono::steady_clock::time_point t0)
+{
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+static bool hasExtension(const string& path, const char* ext)
+{
+	size_t pos = path.find_last_of('.');
+	return pos != string::npos && path.substr(pos + 1) == ext;
+}
+
+static bool wants(const string& solvers, const char* name)
+{
+	return ("," + solvers + ",").find(string(",") + name + ",") != string::npos;
+}
+
+static void report(const char* name, double ms, bool found, const MazePath& path, size_t expanded)
+{
+	printf("%-7s %10.3f ms  ", name, ms);
+	if (found)
+		printf("path %zu steps, %zu nodes expanded\n", path.size(), expanded);
+	else
+		printf("no path\n");
+}
+
+// Solvers that are templates over the grid and so run on a mapped .mazb
+static bool inPlace(const string& name)
+{
+	return name == "dfs" || name == "bfs" || name == "astar" || name == "jps" || name == "bibfs" || name == "biastar";
+}
+
+template <class Engine, class Grid>
+static bool run(const char* name, const Grid& grid)
+{
+	Engine engine;
+	MazePath path;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	bool found = engine.solve(grid, path);
+	report(name, msSince(t0), found, path, engine.expanded);
+	return found;
+}
+
+template <class Grid>
+static bool solveInPlace(const Grid& grid, const string& solvers)
+{
+	bool found = true;
+	if (wants(solvers, "dfs"))
+		found = run<MazeDfs>("dfs", grid) && found;
+	if (wants(solvers, "bfs"))
+		found = run<MazeBfs>("bfs", grid) && found;
+	if (wants(solvers, "astar"))
+		found = run<MazeAstar>("astar", grid) && found;
+	if (wants(solvers, "jps"))
+		found = run<MazeJps>("jps", grid) && found;
+	if (wants(solvers, "bibfs"))
+		found = run<MazeBiBfs>("bibfs", grid) && found;
+	if (wants(solvers, "biastar"))
+		found = run<MazeBiAstar>("biastar", grid) && found;
+	return found;
+}
+
+// Every other solver, through the solver interface on a loaded grid
+static bool solveGrid(const MazeGrid& grid, const string& solvers, int threads, bool skipInPlace)
+{
+	MazePath path;
+	bool found = true;
+	const vector<string>& names = mazeSolverNames();
+	for (size_t i = 0; i < names.size(); i++) {
+		if (!wants(solvers, names[i].c_str()) || (skipInPlace && inPlace(names[i])))
+			continue;
+		unique_ptr<MazeSolver> solver(createMazeSolver(names[i], threads));
+		chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+		bool ok = solver->solve(grid, path);
+		double ms = msSince(t0);
+		string name = solver->name();
+		if (name == "pbfs")
+			name += "/" + to_string(threads > 0 ? threads : MazeThreadPool::hardwareThreads());
+		report(name.c_str(), ms, ok, path, solver->nodesExpanded());
+		found = ok && found;
+	}
+	return found;
+}
+
+static bool loadGrid(const string& path, MazeGrid& grid)
+{
+	string error;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	if (!loadMazeFile(path, grid, &error)) {
+		printf("%s: %s\n", path.c_str(), error.c_str());
+		return false;
+	}
+	printf("load    %10.3f ms\n", msSince(t0));
+	printf("maze    %d x %d (%zu cells)\n", grid.height(), grid.width(), grid.cellCount());
+	return true;
+}
+
+static void cacheReport(const MazeTiledGrid& tiled)
+{
+	printf("cache   %zu tiles of %d x %d (%.1f MB): %zu hits, %zu prefetched, %zu misses\n",
+		tiled.cacheTiles(), tiled.tileSize(), tiled.tileSize(), tiled.memoryBytes() / 1048576.0,
+		tiled.hits(), tiled.prefetchHits(), tiled.misses());
+}
+
+static int solve(const string& file, const string& solvers, int threads, size_t cacheBytes)
+{
+	// A .mazb is solved in place and a .mazt through its tile cache where
+	// the solver allows it
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	MazeBinView view;
+	MazeTiledGrid tiled;
+	bool found = true;
+	bool mapped = view.open(file);
+	bool paged = !mapped && tiled.open(file, cacheBytes);
+	if (mapped || paged) {
+		printf("open    %10.3f ms\n", msSince(t0));
+		if (mapped) {
+			printf("maze    %d x %d (%zu cells)\n", view.height(), view.width(), view.cellCount());
+			found = solveInPlace(view, solvers);
+			view.close();
+		}
+		else {
+			printf("maze    %d x %d (%zu cells)\n", tiled.height(), tiled.width(), tiled.cellCount());
+			found = solveInPlace(tiled, solvers);
+			cacheReport(tiled);
+			tiled.close();
+		}
+		bool rest = false;
+		const vector<string>& names = mazeSolverNames();
+		for (size_t i = 0; i < names.size(); i++)
+			rest = rest || (wants(solvers, names[i].c_str()) && !inPlace(names[i]));
+		if (!rest)
+			return found ? 0 : 1;
+	}
+
+	MazeGrid grid;
+	if (!loadGrid(file, grid))
+		return 1;
+	found = solveGrid(grid, solvers, threads, mapped || paged) && found;
+	return found ? 0 : 1;
+}
+
+// Parallel BFS with a growing number of threads
+static int scale(const string& file, int maxThreads)
+{
+	MazeGrid grid;
+	if (!loadGrid(file, grid))
+		return 1;
+
+	MazePath path;
+	double base = 0;
+	for (int t = 1; ; t = t * 2 < maxThreads ? t * 2 : maxThreads) {
+		MazeParallelBfs pbfs(t);
+		chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+		bool found = pbfs.solve(grid, path);
+		double ms = msSince(t0);
+		if (t == 1) base = ms;
+		printf("pbfs  %3d threads %10.3f ms  speedup %5.2fx  %s\n", t, ms, base / ms, found ? "" : "no path");
+		if (t == maxThreads)
+			break;
+	}
+	return 0;
+}
+
+// Save in the format given by the extension of path
+static bool save(const MazeGrid& grid, const string& path, string* error)
+{
+	if (hasExtension(path, "mazb"))
+		return saveMazBin(grid, path, error);
+	if (hasExtension(path, "mazt"))
+		return saveMazTiled(grid, path, 256, error);
+	return saveMaz(grid, path, error);
+}
+
+static int convert(const string& in, const string& out)
+{
+	MazeGrid grid;
+	string error;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	if (!loadMazeFile(in, grid, &error)) {
+		printf("%s: %s\n", in.c_str(), error.c_str());
+		return 1;
+	}
+	printf("load    %10.3f ms\n", msSince(t0));
+
+	t0 = chrono::steady_clock::now();
+	if (!save(grid, out, &error)) {
+		printf("%s: %s\n", out.c_str(), error.c_str());
+		return 1;
+	}
+	printf("save    %10.3f ms\n", msSince(t0));
+	return 0;
+}
+
+static int oracle(const string& file, size_t queries)
+{
+	MazeGrid grid;
+	if (!loadGrid(file, grid))
+		return 1;
+
+	MazeTreeOracle tree;
+	string error;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	if (!tree.build(grid, &error)) {
+		printf("%s: %s\n", file.c_str(), error.c_str());
+		return 1;
+	}
+	printf("build   %10.3f ms  %.1f MB\n", msSince(t0), tree.memoryBytes() / 1048576.0);
+
+	// Entrance to exit must agree with a search
+	MazeBfs bfs;
+	MazePath path;
+	bfs.solve(grid, path);
+	size_t start = grid.index(grid.entranceRow, grid.entranceCol);
+	size_t goal = grid.index(grid.exitRow, grid.exitCol);
+	printf("check   distance %u, bfs %zu\n", tree.distance(start, goal), path.size());
+
+	MazeRandom random(queries);
+	vector<MazeCellPair> pairs(queries);
+	for (size_t i = 0; i < queries; i++) {
+		pairs[i].src = (uint32_t)(random.next() % grid.cellCount());
+		pairs[i].dst = (uint32_t)(random.next() % grid.cellCount());
+	}
+	vector<uint32_t> out(queries);
+	t0 = chrono::steady_clock::now();
+	tree.distances(pairs.data(), queries, out.data());
+	double ms = msSince(t0);
+	printf("query   %10.3f ms  %zu distances, %.1f ns each\n", ms, queries, ms * 1e6 / (queries ? queries : 1));
+
+	size_t steps = 0, count = queries < 1000 ? queries : 1000;
+	t0 = chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++) {
+		tree.path(pairs[i].src, pairs[i].dst, path);
+		steps += path.size();
+		if (path.size() != out[i]) {
+			printf("path %zu has %zu steps, distance says %u\n", i, path.size(), out[i]);
+			return 1;
+		}
+	}
+	printf("path    %10.3f ms  %zu paths, %zu steps\n", msSince(t0), count, steps);
+	return 0;
+}
+
+// Walk path from its start and check it ends at cell goal
+static bool walks(const MazeGrid& grid, const MazePath& path, size_t goal)
+{
+	int row = path.startRow, col = path.startCol;
+	for (size_t i = 0; i < path.size(); i++) {
+		int dir = path.at(i);
+		if (!grid.canMove(row, col, dir))
+			return false;
+		row += MAZE_DROW[dir];
+		col += MAZE_DCOL[dir];
+	}
+	return grid.index(row, col) == goal;
+}
+
+// Time count queries with HPA* and flat A* and compare the lengths
+static bool hpaBatch(MazeGrid& grid, MazeHpa& hpa, const vector<MazeCellPair>& pairs, size_t count)
+{
+	vector<uint32_t> out(count);
+	size_t abstractExpanded = 0;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++) {
+		out[i] = hpa.distance(grid, pairs[i].src, pairs[i].dst);
+		abstractExpanded += hpa.expanded;
+	}
+	double hpaMs = msSince(t0);
+
+	MazeAstar astar;
+	MazePath path;
+	size_t exact = 0, extra = 0, worst = 0, flatExpanded = 0;
+	t0 = chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++) {
+		grid.entranceRow = (int)(pairs[i].src / grid.width());
+		grid.entranceCol = (int)(pairs[i].src % grid.width());
+		grid.exitRow = (int)(pairs[i].dst / grid.width());
+		grid.exitCol = (int)(pairs[i].dst % grid.width());
+		bool found = astar.solve(grid, path);
+		flatExpanded += astar.expanded;
+		if (found != (out[i] != UINT32_MAX) || (found && out[i] < path.size())) {
+			printf("query %zu: hpa %u, astar %zu\n", i, out[i], found ? path.size() : 0);
+			return false;
+		}
+		if (!found || out[i] == path.size())
+			exact++;
+		else {
+			extra += out[i] - path.size();
+			if (out[i] - path.size() > worst)
+				worst = out[i] - path.size();
+		}
+	}
+	double flatMs = msSince(t0);
+
+	printf("hpa     %10.3f ms  %zu queries, %.1f us each, %.1f nodes each\n", hpaMs, count,
+		hpaMs * 1e3 / count, (double)abstractExpanded / count);
+	printf("astar   %10.3f ms  %zu queries, %.1f us each, %.1f cells each\n", flatMs, count,
+		flatMs * 1e3 / count, (double)flatExpanded / count);
+	printf("speedup %10.1fx  %zu exact, %zu longer by %zu steps in all, worst %zu\n",
+		flatMs / (hpaMs > 0 ? hpaMs : 1e-3), exact, count - exact, extra, worst);
+
+	// Refined paths must be walkable and as long as the distance
+	for (size_t i = 0; i < count && i < 100; i++) {
+		if (out[i] == UINT32_MAX)
+			continue;
+		if (!hpa.path(grid, pairs[i].src, pairs[i].dst, path) || path.size() != out[i]
+			|| !walks(grid, path, pairs[i].dst)) {
+			printf("path %zu does not match its distance %u\n", i, out[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static int hpaBench(const string& file, size_t queries, int clusterSize)
+{
+	MazeGrid grid;
+	if (!loadGrid(file, grid))
+		return 1;
+	if (grid.cellCount() >= UINT32_MAX) {
+		printf("%s: maze is too large\n", file.c_str());
+		return 1;
+	}
+
+	MazeHpa hpa(clusterSize);
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	hpa.build(grid);
+	double buildMs = msSince(t0);
+	printf("build   %10.3f ms  %zu clusters, %zu nodes, %zu edges, %.1f MB\n", buildMs, hpa.clusterCount(),
+		hpa.nodeCount(), hpa.edgeCount(), hpa.memoryBytes() / 1048576.0);
+
+	MazeRandom random(queries);
+	vector<MazeCellPair> pairs(queries);
+	for (size_t i = 0; i < queries; i++) {
+		pairs[i].src = (uint32_t)(random.next() % grid.cellCount());
+		pairs[i].dst = (uint32_t)(random.next() % grid.cellCount());
+	}
+	if (!hpaBatch(grid, hpa, pairs, queries))
+		return 1;
+
+	// Flip random inner walls and rebuild only the clusters next to them
+	size_t changes = 1000, rebuilt = 0;
+	t0 = chrono::steady_clock::now();
+	for (size_t i = 0; i < changes; i++) {
+		int row = (int)(random.next() % grid.height());
+		int col = (int)(random.next() % grid.width());
+		int dir = (int)(random.next() % 4);
+		int nr = row + MAZE_DROW[dir], nc = col + MAZE_DCOL[dir];
+		if (nr < 0 || nr >= grid.height() || nc < 0 || nc >= grid.width())
+			continue;
+		grid.setWall(row, col, dir, grid.canMove(row, col, dir));
+		rebuilt += hpa.update(grid, row, col, dir);
+	}
+	double ms = msSince(t0);
+	printf("update  %10.3f ms  %zu wall changes, %zu clusters rebuilt, %.1f us each (full build %.3f ms)\n",
+		ms, changes, rebuilt, ms * 1e3 / changes, buildMs);
+	return hpaBatch(grid, hpa, pairs, queries) ? 0 : 1;
+}
+
+static int edit(const string& file, size_t edits)
+{
+	MazeGrid grid;
+	if (!loadGrid(file, grid))
+		return 1;
+
+	MazeLpa lpa;
+	MazePath path;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	bool found = lpa.solve(grid, path);
+	report("lpa", msSince(t0), found, path, lpa.expanded);
+
+	MazeAstar astar;
+	MazePath check;
+	MazeRandom random(edits);
+	size_t touched = 0, expanded = 0, flatExpanded = 0, done = 0;
+	double lpaMs = 0, flatMs = 0;
+	size_t goal = grid.index(grid.exitRow, grid.exitCol);
+	while (done < edits) {
+		int row = (int)(random.next() % grid.height());
+		int col = (int)(random.next() % grid.width());
+		int dir = (int)(random.next() % 4);
+		int nr = row + MAZE_DROW[dir], nc = col + MAZE_DCOL[dir];
+		if (nr < 0 || nr >= grid.height() || nc < 0 || nc >= grid.width())
+			continue;
+		grid.setWall(row, col, dir, grid.canMove(row, col, dir));
+		done++;
+
+		t0 = chrono::steady_clock::now();
+		found = lpa.wallChanged(grid, row, col, dir, path);
+		lpaMs += msSince(t0);
+		touched += lpa.touched;
+		expanded += lpa.expanded;
+
+		t0 = chrono::steady_clock::now();
+		bool flatFound = astar.solve(grid, check);
+		flatMs += msSince(t0);
+		flatExpanded += astar.expanded;
+		if (found != flatFound || (found && (path.size() != check.size() || !walks(grid, path, goal)))) {
+			printf("edit %zu: lpa %zu, astar %zu\n", done, found ? path.size() : 0, flatFound ? check.size() : 0);
+			return 1;
+		}
+	}
+	if (edits == 0)
+		return 0;
+	printf("lpa     %10.3f ms  %zu edits, %.1f us each, %.1f touched, %.1f expanded each\n", lpaMs, edits,
+		lpaMs * 1e3 / edits, (double)touched / edits, (double)expanded / edits);
+	printf("astar   %10.3f ms  %zu edits, %.1f us each, %.1f expanded each\n", flatMs, edits,
+		flatMs * 1e3 / edits, (double)flatExpanded / edits);
+	return 0;
+}
+
+static int render(const string& file, const string& out, int cellPixels, int wallPixels, const string& solverName, int threads)
+{
+	MazeGrid grid;
+	if (!loadGrid(file, grid))
+		return 1;
+
+	MazePath path;
+	bool withPath = !solverName.empty();
+	if (withPath) {
+		unique_ptr<MazeSolver> solver(createMazeSolver(solverName));
+		if (!solver) {
+			printf("unknown solver %s\n", solverName.c_str());
+			return 2;
+		}
+		chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+		withPath = solver->solve(grid, path);
+		printf("%-8s %9.3f ms  path %zu steps%s\n", solver->name(), msSince(t0), path.size(), withPath ? "" : ", no path");
+	}
+
+	MazeImageStyle style;
+	style.cellPixels = cellPixels;
+	style.wallPixels = wallPixels;
+	int width, height;
+	mazeImageSize(grid, style, width, height);
+	string error;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	if (!mazeWriteImage(grid, out, style, withPath ? &path : nullptr, threads, &error)) {
+		printf("%s: %s\n", out.c_str(), error.c_str());
+		return 1;
+	}
+	double ms = msSince(t0);
+	printf("render  %10.3f ms  %d x %d pixels, %.1f Mpixels/s\n", ms, width, height, (double)width * height / ms / 1000.0);
+	return 0;
+}
+
+static int generate(const string& out, int height, int width, uint64_t seed, int threads)
+{
+	string error;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	if (threads < 0 && hasExtension(out, "mazt")) {
+		// Rows go straight into bands of tiles
+		MazeEller eller(width, seed);
+		MazeTiledWriter writer;
+		bool ok = writer.open(out, height, width, 256, &error);
+		for (int i = 0; ok && i < height; i++)
+			ok = writer.writeRow(eller.nextRow(i == height - 1));
+		if (!writer.close(ok ? &error : nullptr) || !ok) {
+			printf("%s: %s\n", out.c_str(), error.empty() ? "write failed" : error.c_str());
+			return 1;
+		}
+	}
+	else if (threads < 0) {
+		if (!generateMazeFile(out, height, width, seed, hasExtension(out, "mazb"), &error)) {
+			printf("%s: %s\n", out.c_str(), error.c_str());
+			return 1;
+		}
+	}
+	else {
+		MazeGrid grid;
+		generateMazeParallel(grid, height, width, seed, threads);
+		double ms = msSince(t0);
+		printf("tiles   %10.3f ms  %.1f Mcells/s\n", ms, (double)height * width / ms / 1000.0);
+		if (!save(grid, out, &error)) {
+			printf("%s: %s\n", out.c_str(), error.c_str());
+			return 1;
+		}
+	}
+	double ms = msSince(t0);
+	printf("generate %9.3f ms  %d x %d, %.1f Mcells/s\n", ms, height, width, (double)height * width / ms / 1000.0);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 4 && strcmp(argv[1], "convert") == 0)
+		return convert(argv[2], argv[3]);
+	if (argc >= 5 && argc <= 7 && strcmp(argv[1], "generate") == 0)
+		return generate(argv[2], atoi(argv[3]), atoi(argv[4]), argc >= 6 ? strtoull(argv[5], nullptr, 10) : 1, argc == 7 ? atoi(argv[6]) : -1);
+	if ((argc == 3 || argc == 4) && strcmp(argv[1], "oracle") == 0)
+		return oracle(argv[2], argc == 4 ? strtoull(argv[3], nullptr, 10) : 1000000);
+	if (argc >= 3 && argc <= 5 && strcmp(argv[1], "hpa") == 0)
+		return hpaBench(argv[2], argc >= 4 ? strtoull(argv[3], nullptr, 10) : 1000, argc == 5 ? atoi(argv[4]) : 32);
+	if ((argc == 3 || argc == 4) && strcmp(argv[1], "edit") == 0)
+		return edit(argv[2], argc == 4 ? strtoull(argv[3], nullptr, 10) : 1000);
+	if (argc >= 4 && argc <= 8 && strcmp(argv[1], "render") == 0)
+		return render(argv[2], argv[3], argc >= 5 ? atoi(argv[4]) : 4, argc >= 6 ? atoi(argv[5]) : 1,
+			argc >= 7 ? argv[6] : "", argc == 8 ? atoi(argv[7]) : 0);
+	if ((argc == 3 || argc == 4) && strcmp(argv[1], "scale") == 0)
+		return scale(argv[2], argc == 4 ? atoi(argv[3]) : MazeThreadPool::hardwareThreads());
+
+	string solvers = "dfs,bfs,wave,wave-s,pbfs,astar,jps,bibfs,biastar,lpa";
+	int threads = 0;
+	size_t cacheBytes = 64 << 20;
+	string file;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+			solvers = argv[++i];
+		else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+			cacheBytes = (size_t)atoi(argv[++i]) << 20;
+		else if (file.empty())
+			file = argv[i];
+		else
+			threads = -1;
+	}
+	if (file.empty() || threads < 0) {
+		printf("usage: %s [-s solvers] [-t threads] [-c cacheMB] <file.maz | file.mazb | file.mazt>\n", argv[0]);
+		printf("       %s scale <file> [threads]\n", argv[0]);
+		printf("       %s convert <in> <out>\n", argv[0]);
+		printf("       %s oracle <file> [queries]\n", argv[0]);
+		printf("       %s hpa <file> [queries] [clusterSize]\n", argv[0]);
+		printf("       %s edit <file> [edits]\n", argv[0]);
+		printf("       %s render <file> <out.png | out.ppm> [cellPixels] [wallPixels] [solver] [threads]\n", argv[0]);
+		printf("       %s generate <out> <height> <width> [seed] [threads]\n", argv[0]);
+		return 2;
+	}
+	return solve(file, solvers, threads, cacheBytes);
+}